@@ -5,53 +5,33 @@
 ALU::ALU() : zero_flag(false), result(0) {}
 
 int32_t ALU::execute(int32_t operand1, int32_t operand2, int aluOp) {
-    switch(aluOp) {
-        case 0x0: // ADD
-        case 0x8: // LB/SB address calculation
-        case 0x9: // LW/SW address calculation
-        case 0xA: // SB address calculation
-        case 0xB: // SW address calculation
-        case 0xD: // JAL (store return address)     For JAL, operand1 is typically PC, operand2 is typically 4
-            result = operand1 + operand2;
-            break;
-            
-        case 0x4: // XOR
-            result = operand1 ^ operand2;
-            break;
-            
-        case 0x5: // SRAI (Shift Right Arithmetic Immediate)
-            // operand2 contains the shift amount (shamt)
-            result = operand1 >> (operand2 & 0x1F); // Only use bottom 5 bits
-            // Preserve sign bit for arithmetic shift
-            if (operand1 < 0) {
-                result |= (~0U << (32 - (operand2 & 0x1F)));
-            }
-            break;
-            
-        case 0x6: // ORI
-            result = operand1 | operand2;
-            break;
-            
-        case 0xC: // BEQ comparison
-            result = (operand1 == operand2) ? 1 : 0;
-            zero_flag = (result == 1);
-            break;
-            
-        case 0xE: // LUI (Load Upper Immediate)
-            // For LUI, operand1 contains the immediate value already shifted
-            result = operand1;
-            break;
-            
+    result = alu_result(operand1, operand2, aluOp);
+    // BEQ sets the zero flag when the operands are equal, everything else when the result is 0
+    zero_flag = aluOp == 0xC ? result == 1 : result == 0;
+    return result;
+}
+
+int32_t ALU::atomic_result(int funct5, int32_t memory, int32_t operand) {
+    switch(funct5) {
+        case 0x00: // AMOADD
+            return (int32_t)((uint32_t)memory + (uint32_t)operand);
+        case 0x01: // AMOSWAP
+            return operand;
+        case 0x04: // AMOXOR
+            return memory ^ operand;
+        case 0x08: // AMOOR
+            return memory | operand;
+        case 0x0C: // AMOAND
+            return memory & operand;
+        case 0x10: // AMOMIN
+            return memory < operand ? memory : operand;
+        case 0x14: // AMOMAX
+            return memory > operand ? memory : operand;
+        case 0x18: // AMOMINU
+            return (uint32_t)memory < (uint32_t)operand ? memory : operand;
+        case 0x1C: // AMOMAXU
+            return (uint32_t)memory > (uint32_t)operand ? memory : operand;
         default:
-            // Handle invalid ALU operation
-            result = 0;
-            break;
+            return memory;
     }
-    
-    // Update zero flag (except for branch operations where it's set explicitly)
-    if (aluOp != 0xC) {
-        zero_flag = (result == 0);
-    }
-    
-    return result;
-}
\ No newline at end of file
+}
@@ -5,6 +5,27 @@
 
 #include <cstdint>
 
+// Result of one ALU operation; shared by ALU::execute and the pre-decoded
+// engines so they cannot drift apart. Addition wraps, SRAI shifts
+// arithmetically by the low 5 bits, unknown operations give 0.
+inline int32_t alu_result(int32_t operand1, int32_t operand2, int aluOp) {
+    switch (aluOp) {
+        case 0x0: // ADD
+        case 0x8: // LB/SB address calculation
+        case 0x9: // LW/SW address calculation
+        case 0xA: // SB address calculation
+        case 0xB: // SW address calculation
+        case 0xD: // JAL return address
+            return (int32_t)((uint32_t)operand1 + (uint32_t)operand2);
+        case 0x4: return operand1 ^ operand2;           // XOR
+        case 0x5: return operand1 >> (operand2 & 0x1F); // SRAI
+        case 0x6: return operand1 | operand2;           // ORI
+        case 0xC: return operand1 == operand2;          // BEQ comparison
+        case 0xE: return operand1;                      // LUI, immediate already shifted
+        default:  return 0;
+    }
+}
+
 class ALU {
 private:
     // Internal flags
@@ -17,6 +38,9 @@ public:
     // Main ALU operation function
     int32_t execute(int32_t operand1, int32_t operand2, int aluOp);
     
+    // Value an RV32A AMO (selected by funct5) stores, given the old memory value
+    static int32_t atomic_result(int funct5, int32_t memory, int32_t operand);
+
     // Flag access methods
     bool isZero() const { return zero_flag; }
     int32_t getResult() const { return result; }
@@ -0,0 +1,122 @@
+// file: Assembler.h
+
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+// Encoders for the instructions the simulator implements and a small
+// buffer to build programs in, for generated workloads and benchmarks.
+// Offsets of branches and jumps are in bytes relative to the instruction.
+
+inline uint32_t rv_r(unsigned funct7, unsigned funct3, unsigned rd, unsigned rs1, unsigned rs2) {
+    return funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | 0x33;
+}
+
+inline uint32_t rv_i(unsigned opcode, unsigned funct3, unsigned rd, unsigned rs1, int32_t imm) {
+    return (uint32_t)(imm & 0xFFF) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+inline uint32_t rv_s(unsigned funct3, unsigned rs2, unsigned rs1, int32_t imm) {
+    return (uint32_t)(imm >> 5 & 0x7F) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | (imm & 0x1F) << 7 | 0x23;
+}
+
+inline uint32_t rv_add(unsigned rd, unsigned rs1, unsigned rs2) { return rv_r(0x00, 0x0, rd, rs1, rs2); }
+inline uint32_t rv_xor(unsigned rd, unsigned rs1, unsigned rs2) { return rv_r(0x00, 0x4, rd, rs1, rs2); }
+inline uint32_t rv_addi(unsigned rd, unsigned rs1, int32_t imm) { return rv_i(0x13, 0x0, rd, rs1, imm); }
+inline uint32_t rv_ori(unsigned rd, unsigned rs1, int32_t imm) { return rv_i(0x13, 0x6, rd, rs1, imm); }
+inline uint32_t rv_srai(unsigned rd, unsigned rs1, unsigned shamt) { return rv_i(0x13, 0x5, rd, rs1, 0x400 | (shamt & 0x1F)); }
+inline uint32_t rv_lb(unsigned rd, unsigned rs1, int32_t imm) { return rv_i(0x03, 0x0, rd, rs1, imm); }
+inline uint32_t rv_lw(unsigned rd, unsigned rs1, int32_t imm) { return rv_i(0x03, 0x2, rd, rs1, imm); }
+inline uint32_t rv_sb(unsigned rs2, unsigned rs1, int32_t imm) { return rv_s(0x0, rs2, rs1, imm); }
+inline uint32_t rv_sw(unsigned rs2, unsigned rs1, int32_t imm) { return rv_s(0x2, rs2, rs1, imm); }
+inline uint32_t rv_lui(unsigned rd, uint32_t upper) { return (upper & 0xFFFFF) << 12 | rd << 7 | 0x37; }
+
+inline uint32_t rv_beq(unsigned rs1, unsigned rs2, int32_t offset) {
+    uint32_t imm = (uint32_t)offset;
+    return (imm >> 12 & 1) << 31 | (imm >> 5 & 0x3F) << 25 | rs2 << 20 | rs1 << 15 | (imm >> 1 & 0xF) << 8 |
+           (imm >> 11 & 1) << 7 | 0x63;
+}
+
+inline uint32_t rv_jal(unsigned rd, int32_t offset) {
+    uint32_t imm = (uint32_t)offset;
+    return (imm >> 20 & 1) << 31 | (imm >> 1 & 0x3FF) << 21 | (imm >> 11 & 1) << 20 | (imm >> 12 & 0xFF) << 12 |
+           rd << 7 | 0x6F;
+}
+
+class Assembler {
+public:
+    std::vector<uint32_t> words;
+
+    // index of the next instruction, used as a label
+    size_t here() const { return words.size(); }
+    void emit(uint32_t word) { words.push_back(word); }
+
+    // rd = value, in one or two instructions
+    void li(unsigned rd, int32_t value) {
+        if (value >= -2048 && value < 2048) {
+            emit(rv_addi(rd, 0, value));
+            return;
+        }
+        uint32_t upper = ((uint32_t)value + 0x800) >> 12;
+        emit(rv_lui(rd, upper));
+        int32_t lower = value - (int32_t)(upper << 12);
+        if (lower) {
+            emit(rv_addi(rd, rd, lower));
+        }
+    }
+
+    void beq(unsigned rs1, unsigned rs2, size_t target) {
+        emit(rv_beq(rs1, rs2, ((int32_t)target - (int32_t)here()) * 4));
+    }
+    void jal(unsigned rd, size_t target) {
+        emit(rv_jal(rd, ((int32_t)target - (int32_t)here()) * 4));
+    }
+    // points the branch or jump emitted at `at` to `target`
+    void patch(size_t at, size_t target) {
+        int32_t offset = ((int32_t)target - (int32_t)at) * 4;
+        uint32_t word = words[at];
+        if ((word & 0x7F) == 0x63) {
+            words[at] = rv_beq(word >> 15 & 0x1F, word >> 20 & 0x1F, offset);
+        } else {
+            words[at] = rv_jal(word >> 7 & 0x1F, offset);
+        }
+    }
+
+    // the text image format the simulator loads: one hex byte per line,
+    // little endian
+    void write(std::ostream &out) const {
+        char line[4];
+        for (size_t i = 0; i < words.size(); i++) {
+            for (int b = 0; b < 4; b++) {
+                snprintf(line, sizeof(line), "%02x\n", words[i] >> (8 * b) & 0xFF);
+                out.write(line, 3);
+            }
+        }
+    }
+
+    // raw little-endian bytes, as Machine::load_binary takes them
+    void write_binary(std::ostream &out) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            char bytes[4] = { (char)(words[i] & 0xFF), (char)(words[i] >> 8 & 0xFF), (char)(words[i] >> 16 & 0xFF),
+                              (char)(words[i] >> 24) };
+            out.write(bytes, 4);
+        }
+    }
+
+    // the same bytes as one hex string, the image= form of server jobs
+    void write_hex(std::ostream &out) const {
+        char digits[12];
+        for (size_t i = 0; i < words.size(); i++) {
+            snprintf(digits, sizeof(digits), "%02x%02x%02x%02x", words[i] & 0xFF, words[i] >> 8 & 0xFF,
+                     words[i] >> 16 & 0xFF, words[i] >> 24);
+            out.write(digits, 8);
+        }
+        out.put('\n');
+    }
+};
+
+#endif
@@ -0,0 +1,154 @@
+// file: Batch.cpp
+
+#include "Batch.h"
+#include "CPU.h"
+#include "ResultCache.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <mutex>
+#include <sys/stat.h>
+
+RunResult run_program(Program &program, uint64_t max_instructions) {
+    RunResult result;
+    CPU cpu;
+    uint64_t instructions = 0;
+    bool done = true;
+    result.status = "ok";
+    while (done) {
+        if (max_instructions && instructions >= max_instructions) {
+            result.status = "limit";
+            break;
+        }
+        done = cpu.step(program.instructions());
+        if (done) {
+            instructions++;
+        }
+        if (cpu.readPC() > (unsigned long)program.maxPC * 8) {
+            break;
+        }
+    }
+    result.a0 = cpu.get_register_value(10);
+    result.a1 = cpu.get_register_value(11);
+    result.instructions = instructions;
+    for (int reg = 0; reg < 32; reg++) {
+        result.registers[reg] = cpu.get_register_value(reg);
+    }
+    return result;
+}
+
+bool list_batch_programs(const std::string &path, std::vector<std::string> &programs) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+
+    if (S_ISDIR(info.st_mode)) {
+        DIR *dir = opendir(path.c_str());
+        if (!dir) {
+            return false;
+        }
+        std::vector<std::string> names;
+        while (struct dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0) {
+                names.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+        programs.insert(programs.end(), names.begin(), names.end());
+        return true;
+    }
+
+    // manifest: one path per line, blank lines and '#' comments skipped
+    std::ifstream manifest(path.c_str());
+    std::string line;
+    while (std::getline(manifest, line)) {
+        size_t end = line.find_last_not_of(" \t\r");
+        if (end == std::string::npos || line[0] == '#') {
+            continue;
+        }
+        programs.push_back(line.substr(0, end + 1));
+    }
+    return true;
+}
+
+static std::string json_string(const std::string &text) {
+    std::string quoted = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"' || text[i] == '\\') {
+            quoted += '\\';
+        }
+        quoted += text[i];
+    }
+    return quoted + "\"";
+}
+
+static void write_record(std::ostream &out, const std::string &program, const RunResult &result, bool json) {
+    if (json) {
+        out << "{\"program\":" << json_string(program) << ",\"status\":\"" << result.status
+            << "\",\"a0\":" << result.a0 << ",\"a1\":" << result.a1
+            << ",\"instructions\":" << result.instructions << "}\n";
+    } else {
+        out << program << "," << result.status << "," << result.a0 << "," << result.a1 << ","
+            << result.instructions << "\n";
+    }
+}
+
+void run_batch(const std::vector<std::string> &programs, const BatchConfig &config, std::ostream &out) {
+    std::vector<RunResult> results(programs.size());
+    std::vector<bool> finished(programs.size(), false);
+    size_t next_to_write = 0;
+    std::mutex output_lock;
+
+    if (!config.json) {
+        out << "program,status,a0,a1,instructions\n";
+    }
+
+    ResultCache cache;
+    bool cached = !config.cache_file.empty() && cache.open(config.cache_file);
+    if (!config.cache_file.empty() && !cached) {
+        std::cerr << "cannot open result cache " << config.cache_file << std::endl;
+    }
+
+    ThreadPool pool(config.threads);
+    for (size_t i = 0; i < programs.size(); i++) {
+        pool.submit([&, i]() {
+            RunResult result;
+            Program program;
+            if (load_program(programs[i].c_str(), program)) {
+                // batch runs start from the zeroed machine, initial state hash 0
+                RunKey key = run_key(program, 0, config.max_instructions);
+                if (!cached || !cache.lookup(key, result)) {
+                    result = run_program(program, config.max_instructions);
+                    if (cached) {
+                        cache.store(key, result);
+                    }
+                }
+            } else {
+                result.status = "load-error";
+                result.a0 = result.a1 = 0;
+                result.instructions = 0;
+                std::fill(result.registers, result.registers + 32, 0);
+            }
+
+            // records leave in input order as soon as their predecessors are done
+            std::lock_guard<std::mutex> guard(output_lock);
+            results[i] = result;
+            finished[i] = true;
+            while (next_to_write < programs.size() && finished[next_to_write]) {
+                write_record(out, programs[next_to_write], results[next_to_write], config.json);
+                next_to_write++;
+            }
+        });
+    }
+    pool.wait();
+    out.flush();
+    if (cached) {
+        std::cerr << "batch.cache_hits " << cache.hits << std::endl;
+        std::cerr << "batch.cache_misses " << cache.misses << std::endl;
+    }
+}
@@ -0,0 +1,41 @@
+// file: Batch.h
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Program.h"
+
+struct BatchConfig {
+    int threads;                // 0 = all hardware threads
+    uint64_t max_instructions;  // 0 = no limit
+    bool json;                  // JSON lines instead of CSV
+    std::string cache_file;     // whole-run result cache, empty for none
+
+    BatchConfig() : threads(0), max_instructions(0), json(false) {}
+};
+
+struct RunResult {
+    std::string status;         // "ok", "limit" or "load-error"
+    int a0;
+    int a1;
+    uint64_t instructions;
+    int32_t registers[32];      // final register file
+};
+
+// runs a loaded program to completion on a fresh CPU
+RunResult run_program(Program &program, uint64_t max_instructions);
+
+// a manifest lists one program per line; a directory contributes its *.txt files
+bool list_batch_programs(const std::string &path, std::vector<std::string> &programs);
+
+// runs every program on a work-stealing pool and writes one record per
+// program, in input order, to a single CSV or JSON lines stream. With a
+// cache file, programs whose image and initial state were run before are
+// answered from the cache without simulating.
+void run_batch(const std::vector<std::string> &programs, const BatchConfig &config, std::ostream &out);
+
+#endif
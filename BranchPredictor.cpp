@@ -0,0 +1,41 @@
+// file: BranchPredictor.cpp
+
+#include "BranchPredictor.h"
+
+BranchPredictor::BranchPredictor(int entries) : lookups(0), mispredicts(0) {
+    int size = 1;
+    while (size * 2 <= entries) {
+        size *= 2;
+    }
+    counters.assign(size, 1); // weakly not taken
+    index_mask = size - 1;
+}
+
+bool BranchPredictor::predict(uint32_t pc) const {
+    return counters[(pc >> 2) & index_mask] >= 2;
+}
+
+void BranchPredictor::update(uint32_t pc, bool taken) {
+    uint8_t &counter = counters[(pc >> 2) & index_mask];
+    if (taken && counter < 3) {
+        counter++;
+    } else if (!taken && counter > 0) {
+        counter--;
+    }
+}
+
+bool BranchPredictor::predict_and_update(uint32_t pc, bool taken) {
+    bool correct = predict(pc) == taken;
+    lookups++;
+    if (!correct) {
+        mispredicts++;
+    }
+    update(pc, taken);
+    return correct;
+}
+
+void BranchPredictor::set_counters(const std::vector<uint8_t>& values) {
+    if (values.size() == counters.size()) {
+        counters = values;
+    }
+}
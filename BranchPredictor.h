@@ -0,0 +1,32 @@
+// file: BranchPredictor.h
+
+#ifndef BRANCH_PREDICTOR_H
+#define BRANCH_PREDICTOR_H
+
+#include <cstdint>
+#include <vector>
+
+// Bimodal predictor: a table of 2-bit saturating counters indexed by PC
+class BranchPredictor {
+private:
+    std::vector<uint8_t> counters;
+    uint32_t index_mask;
+
+public:
+    uint64_t lookups;
+    uint64_t mispredicts;
+
+    // entries is rounded down to a power of two
+    BranchPredictor(int entries = 4096);
+
+    bool predict(uint32_t pc) const;
+    void update(uint32_t pc, bool taken);
+
+    // predicts, trains and returns whether the prediction was correct
+    bool predict_and_update(uint32_t pc, bool taken);
+
+    const std::vector<uint8_t>& get_counters() const { return counters; }
+    void set_counters(const std::vector<uint8_t>& values);
+};
+
+#endif
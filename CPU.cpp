@@ -7,6 +7,18 @@
 CPU::CPU()
 {
 	PC = 0; //set PC to 0
+	last_mem_address = 0;
+	last_mem_value = 0;
+	shared = NULL;
+	store_log = NULL;
+	reservation_valid = false;
+	reservation_address = 0;
+	reservation_value = 0;
+	coverage = NULL;
+	prev_location = 0;
+	host_phases = NULL;
+	faults = 0;
+	report_faults = true;
 	for (int i = 0; i < 4096; i++) //copy instrMEM
 	{
 		dmemory[i] = (0);
@@ -22,6 +34,10 @@ unsigned long CPU::readPC()
 {
 	return PC;
 }
+void CPU::setPC(unsigned long pc)
+{
+	PC = pc;
+}
 void CPU::incPC()
 {
     // 4 bytes is 8 hex values in the instruction array
@@ -49,6 +65,13 @@ int CPU::get_register_value(int reg) {
 	return static_cast<int>(registers[reg]);
 }
 
+// sets the value of a specific register; x0 stays zero
+void CPU::set_register_value(int reg, int32_t value) {
+	if (reg <= 0 || reg > 31)
+		return;
+	registers[reg] = value;
+}
+
 // decodes an instruction to get control signals and decode the instruction into the necessary parts
 bool CPU::decode_instruction(string inst, bool *regWrite, bool *aluSrc, bool *branch, bool *memRe, bool *memWr, bool *memToReg, bool *upperIm, int *aluOp,
 	unsigned int *opcode, unsigned int *rd, unsigned int *funct3, unsigned int *rs1, unsigned int *rs2, unsigned int *funct7) {
@@ -185,6 +208,17 @@ bool CPU::decode_instruction(string inst, bool *regWrite, bool *aluSrc, bool *br
             *aluOp = 0xE;
             break;
 
+        case 0x2F: // RV32A atomics (LR.W, SC.W, AMO*.W)
+            *regWrite = true;
+            *aluSrc = false;
+            *branch = false;
+            *memRe = true;
+            *memWr = true;
+            *memToReg = true;
+            *upperIm = false;
+            *aluOp = 0xF;
+            break;
+
         case 0x00: // NULL instruction (program end)
 			// cout << "Program end" << endl;
 			return false;
@@ -229,35 +263,49 @@ void CPU::execute(int rd, int rs1, int rs2, int aluOp, int opcode, string inst)
 			PC += immediate * 2 - 8;  // Take branch
             // Subtract 8 because the incPC() will add this later
 		}
+		record_edge();
 	}
 
     // JAL
     else if (opcode == 0x6f) {
-        registers[rd] = PC/2 + 4;
+        if (rd != 0)
+            registers[rd] = PC/2 + 4;
         PC += immediate * 2 - 8;
         // Subtract 8 because the incPC() will add this later
+        record_edge();
     }
 
 	else if (opcode == 0x03) { // Load instructions
         // Use ALU to calculate effective address (base + offset)
         int32_t effective_address = alu.execute(registers[rs1], immediate, aluOp); // ALU_OP for address calculation
+        last_mem_address = effective_address;
+        if (host_phases)
+            enter_host_phase(*host_phases, HOST_MEMORY);
         int32_t result = 0;
         if (aluOp == 0x8) { // LB
 			result = read_memory(effective_address, true);
+			last_mem_value = result;
 			// cout << "Loading register " << rd << " with " << result << endl;
-            registers[rd] = result;
+            if (rd != 0)
+                registers[rd] = result;
         } else if (aluOp == 0x9) { // LW
 			result = read_memory(effective_address, false);
+			last_mem_value = result;
             // cout << "Effective address: " << effective_address << endl;
 			// cout << "Loading register " << rd << " with " << result << endl;
-            registers[rd] = result;
+            if (rd != 0)
+                registers[rd] = result;
         }
     }
 
     else if (opcode == 0x23) { // Store instructions
         // Use ALU to calculate effective address (base + offset)
         int32_t effective_address = alu.execute(registers[rs1], immediate, aluOp); // ALU_OP for address calculation
+        last_mem_address = effective_address;
+        if (host_phases)
+            enter_host_phase(*host_phases, HOST_MEMORY);
 
+        last_mem_value = aluOp == 0xa ? (registers[rs2] & 0xFF) : registers[rs2];
         if (aluOp == 0xa) { // SB
             // cout << "Storing byte of " << registers[rs2] << " to memory address " << effective_address << endl;
             write_memory(effective_address, registers[rs2], true);
@@ -269,6 +317,16 @@ void CPU::execute(int rd, int rs1, int rs2, int aluOp, int opcode, string inst)
         }
     }
 
+    else if (opcode == 0x2f) { // Atomics, address is rs1 without offset
+        last_mem_address = registers[rs1];
+        last_mem_value = registers[rs2];
+        if (host_phases)
+            enter_host_phase(*host_phases, HOST_MEMORY);
+        int32_t result = execute_atomic(registers[rs1], (instruction >> 27) & 0x1F, registers[rs2]);
+        if (rd != 0)
+            registers[rd] = result;
+    }
+
     // LUI
 	else if (opcode == 0x37) {
 		if (rd != 0) { // Don't write to x0
@@ -282,6 +340,82 @@ void CPU::execute(int rd, int rs1, int rs2, int aluOp, int opcode, string inst)
 
 }
 
+// runs one fetch/decode/execute cycle and optionally reports what retired
+bool CPU::step(char *IM, RetiredInst *retired) {
+	bool regWrite, aluSrc, branch, memRe, memWr, memToReg, upperIm;
+	int aluOp;
+	unsigned int opcode, rd, funct3, rs1, rs2, funct7;
+
+	unsigned long pc = PC;
+	if (host_phases)
+		enter_host_phase(*host_phases, HOST_FETCH);
+	string inst = get_instruction(IM);
+	if (host_phases)
+		enter_host_phase(*host_phases, HOST_DECODE);
+	bool running = decode_instruction(inst, &regWrite, &aluSrc, &branch, &memRe, &memWr, &memToReg, &upperIm, &aluOp,
+		&opcode, &rd, &funct3, &rs1, &rs2, &funct7);
+	if (host_phases)
+		enter_host_phase(*host_phases, HOST_EXECUTE);
+	execute(rd, rs1, rs2, aluOp, opcode, inst);
+	if (host_phases)
+		enter_host_phase(*host_phases, HOST_OUTSIDE);
+
+	if (retired) {
+		retired->pc = pc / 2;
+		retired->inst = std::stoul(inst, nullptr, 16);
+		retired->opcode = opcode;
+		retired->rd = rd;
+		retired->rs1 = rs1;
+		retired->rs2 = rs2;
+		retired->aluOp = aluOp;
+		retired->regWrite = regWrite && rd != 0;
+		retired->memRe = memRe;
+		retired->memWr = memWr;
+		retired->branch = branch;
+		retired->taken = (PC != pc);
+		retired->mem_address = last_mem_address;
+		retired->mem_value = last_mem_value;
+		retired->result = registers[rd];
+	}
+
+	incPC();
+	return running;
+}
+
+// LR.W, SC.W and the AMOs; returns the value written to rd
+int32_t CPU::execute_atomic(uint32_t address, int funct5, int32_t operand) {
+    if (!check_address_alignment(address, 4)) {
+        return 0;
+    }
+
+    if (funct5 == 0x02) { // LR.W
+        reservation_valid = true;
+        reservation_address = address;
+        reservation_value = shared ? shared->load_reserved(address) : read_memory(address, false);
+        return reservation_value;
+    }
+
+    if (funct5 == 0x03) { // SC.W, 0 on success
+        bool success = reservation_valid && reservation_address == address;
+        reservation_valid = false;
+        if (success) {
+            if (shared) {
+                success = shared->store_conditional(address, reservation_value, operand);
+            } else {
+                write_memory(address, operand, false);
+            }
+        }
+        return success ? 0 : 1;
+    }
+
+    if (shared) {
+        return shared->atomic_op(address, funct5, operand);
+    }
+    int32_t old = read_memory(address, false);
+    write_memory(address, ALU::atomic_result(funct5, old, operand), false);
+    return old;
+}
+
 // generates immediate for the given instruction
 int32_t CPU::generate_immediate(uint32_t instruction, int opcode) {
     int32_t imm = 0;
@@ -347,23 +481,47 @@ int32_t CPU::sign_extend(int32_t value, int bits) {
 // Memory access alignment check
 bool CPU::check_address_alignment(uint32_t address, uint32_t bytes) {
     if (address >= MEMORY_SIZE) {
-        std::cerr << "Memory access out of bounds: " << address << std::endl;
+        faults++;
+        if (report_faults)
+            std::cerr << "Memory access out of bounds: " << address << std::endl;
         return false;
     }
     
     if (bytes == 4 && (address % 4 != 0)) {
-        std::cerr << "Unaligned word access at address: " << address << std::endl;
+        faults++;
+        if (report_faults)
+            std::cerr << "Unaligned word access at address: " << address << std::endl;
         return false;
     }
     
     return true;
 }
 
+void CPU::attach_memory(SharedMemory *memory) {
+    shared = memory;
+}
+
+void CPU::attach_store_log(StoreLog *log) {
+    store_log = log;
+}
+
+void CPU::attach_coverage(uint8_t *map) {
+    coverage = map;
+    prev_location = 0;
+}
+
+void CPU::attach_host_phases(HostPhases *phases) {
+    host_phases = phases;
+}
+
 // Memory read operation
 int32_t CPU::read_memory(uint32_t address, bool is_byte) {
     if (!check_address_alignment(address, is_byte ? 1 : 4)) {
         return 0;
     }
+    if (shared) {
+        return store_log ? store_log->read(*shared, address, is_byte) : shared->read(address, is_byte);
+    }
     
     if (is_byte) {
         // Load byte (LB) - sign extend from 8 bits
@@ -384,6 +542,13 @@ void CPU::write_memory(uint32_t address, int32_t value, bool is_byte) {
     if (!check_address_alignment(address, is_byte ? 1 : 4)) {
         return;
     }
+    if (shared) {
+        if (store_log)
+            store_log->write(address, value, is_byte);
+        else
+            shared->write(address, value, is_byte);
+        return;
+    }
     
     if (is_byte) {
         // Store byte (SB)
@@ -1,11 +1,17 @@
 // file: CPU.h
 
+#ifndef CPU_H
+#define CPU_H
+
 #include <iostream>
 #include <bitset>
 #include <stdio.h>
 #include<stdlib.h>
 #include <string>
 #include "ALU.h"
+#include "SharedMemory.h"
+#include "StoreLog.h"
+#include "HostPhases.h"
 using namespace std;
 
 
@@ -16,32 +22,121 @@ using namespace std;
 
 // };
 
+// record of one retired instruction, consumed by the timing models
+struct RetiredInst {
+	uint32_t pc;			// byte address of the instruction
+	uint32_t inst;			// raw instruction word
+	unsigned int opcode;
+	unsigned int rd;
+	unsigned int rs1;
+	unsigned int rs2;
+	int aluOp;
+	bool regWrite;
+	bool memRe;
+	bool memWr;
+	bool branch;
+	bool taken;				// branch or jump redirected the PC
+	uint32_t mem_address;	// effective address of loads and stores
+	int32_t mem_value;		// value loaded, or stored (the rs2 operand for atomics)
+	int32_t result;			// value written to rd
+};
+
 class CPU {
-private:
+public:
 	static const int MEMORY_SIZE = 4096;
+	static const int COVERAGE_SIZE = 65536;
+
+private:
     int dmemory[MEMORY_SIZE]; 	//data memory byte addressable in little endian fashion;
 	unsigned long PC; //pc 
 	int32_t registers[32];
 	ALU alu;
+	uint32_t last_mem_address; // effective address of the last load/store
+	int32_t last_mem_value;		// value it loaded or stored
+	SharedMemory *shared;	// memory shared with other harts, NULL to use dmemory
+	StoreLog *store_log;	// buffers stores to shared memory until the quantum ends
+
+	// LR/SC reservation
+	bool reservation_valid;
+	uint32_t reservation_address;
+	int32_t reservation_value;
+
+	// edge coverage for fuzzing, NULL when not instrumented
+	uint8_t *coverage;
+	uint32_t prev_location;
+
+	// host perf counters per step phase, NULL when not measuring
+	HostPhases *host_phases;
+
+	// memory faults (out of bounds or unaligned accesses)
+	uint64_t faults;
+	bool report_faults;
+
+	int32_t execute_atomic(uint32_t address, int funct5, int32_t operand);
+
+	// AFL-style edge hit count, bumped on the BEQ/JAL path only
+	inline void record_edge() {
+		if (coverage) {
+			uint32_t location = (uint32_t)(PC + 8) * 0x9E3779B1u >> 16;
+			coverage[location ^ prev_location]++;
+			prev_location = location >> 1;
+		}
+	}
 
-	int32_t generate_immediate(uint32_t instruction, int opcode);
-    int32_t sign_extend(int32_t value, int bits);
     bool check_address_alignment(uint32_t address, uint32_t bytes);
 
 public:
 	CPU();
 	unsigned long readPC();
+	void setPC(unsigned long pc);
 	void incPC();
 	string get_instruction(char *IM);
 	int get_register_value(int reg);
+	void set_register_value(int reg, int32_t value);
 	bool decode_instruction(string inst, bool *regWrite, bool *aluSrc, bool *branch, bool *memRe, bool *memWr, bool *memToReg, bool *upperIm, int *aluOp,
 		unsigned int *opcode, unsigned int *rd, unsigned int *funct3, unsigned int *rs1, unsigned int *rs2, unsigned int *funct7);
 
 	void execute(int rd, int rs1, int rs2, int aluOp, int opcode, string inst);
 
+	int32_t generate_immediate(uint32_t instruction, int opcode);
+    int32_t sign_extend(int32_t value, int bits);
+
+	// use a memory shared between harts instead of the private dmemory
+	void attach_memory(SharedMemory *memory);
+	// route shared memory stores through a log (NULL to store directly)
+	void attach_store_log(StoreLog *log);
+
+	// count branch edges into a COVERAGE_SIZE byte map (NULL to stop)
+	void attach_coverage(uint8_t *map);
+
+	// switch host counter groups at each phase of step (NULL to stop)
+	void attach_host_phases(HostPhases *phases);
+
+	uint64_t get_faults() const { return faults; }
+	// false silences the per-fault messages on stderr
+	void set_report_faults(bool report) { report_faults = report; }
+
 	int32_t read_memory(uint32_t address, bool is_byte);
     void write_memory(uint32_t address, int32_t value, bool is_byte);
+
+	// fetch, decode and execute one instruction; returns false at program end
+	bool step(char *IM, RetiredInst *retired = NULL);
+
+	// step() reporting to an instrumentation policy (see Instrumentation.h);
+	// a disabled policy compiles down to the plain step
+	template <class Policy>
+	bool step(char *IM, Policy &policy) {
+		if (!Policy::enabled)
+			return step(IM);
+		RetiredInst retired;
+		bool running = step(IM, &retired);
+		if (running)
+			policy.retire(retired);
+		return running;
+	}
 	
 };
 
 // add other functions and objects here
+
+#endif
@@ -0,0 +1,71 @@
+// file: Cache.cpp
+
+#include "Cache.h"
+
+static int floor_log2(int value) {
+    int bits = 0;
+    while ((2 << bits) <= value) {
+        bits++;
+    }
+    return bits;
+}
+
+Cache::Cache(int size_bytes, int ways, int line_bytes) : clock(0), hits(0), misses(0), writebacks(0) {
+    if (ways < 1) ways = 1;
+    line_shift = floor_log2(line_bytes < 4 ? 4 : line_bytes);
+    int sets = (size_bytes >> line_shift) / ways;
+    set_shift = floor_log2(sets < 1 ? 1 : sets);
+    num_sets = 1 << set_shift;
+    num_ways = ways;
+    Line empty = {0, 0, false, false};
+    lines.assign(num_sets * num_ways, empty);
+}
+
+bool Cache::access(uint32_t address, bool is_write) {
+    uint32_t block = address >> line_shift;
+    uint32_t set = block & (num_sets - 1);
+    uint32_t tag = block >> set_shift;
+    Line *base = &lines[set * num_ways];
+    clock++;
+
+    Line *victim = base;
+    for (int way = 0; way < num_ways; way++) {
+        Line &line = base[way];
+        if (line.valid && line.tag == tag) {
+            line.last_used = clock;
+            line.dirty |= is_write;
+            hits++;
+            return true;
+        }
+        if (!line.valid || (victim->valid && line.last_used < victim->last_used)) {
+            victim = &line;
+        }
+    }
+
+    misses++;
+    if (victim->valid && victim->dirty) {
+        writebacks++;
+    }
+    victim->valid = true;
+    victim->dirty = is_write;
+    victim->tag = tag;
+    victim->last_used = clock;
+    return false;
+}
+
+void Cache::reset_stats() {
+    hits = 0;
+    misses = 0;
+    writebacks = 0;
+}
+
+void Cache::set_lines(const std::vector<Line>& values) {
+    if (values.size() == lines.size()) {
+        lines = values;
+        for (std::size_t i = 0; i < lines.size(); i++) {
+            if (lines[i].last_used > clock) {
+                clock = lines[i].last_used;
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+// file: Cache.h
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+// Set-associative cache with LRU replacement. Only tags are modelled;
+// the data itself always lives in the CPU's memory.
+class Cache {
+public:
+    struct Line {
+        uint32_t tag;
+        uint64_t last_used;
+        bool valid;
+        bool dirty;
+    };
+
+private:
+    std::vector<Line> lines; // sets * ways, allocated once
+    int num_sets;
+    int num_ways;
+    int line_shift;
+    int set_shift;
+    uint64_t clock;
+
+public:
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t writebacks;
+
+    // size and line size in bytes; sizes are rounded down to powers of two
+    Cache(int size_bytes = 16384, int ways = 4, int line_bytes = 64);
+
+    // returns true on a hit; misses allocate the line
+    bool access(uint32_t address, bool is_write);
+    void reset_stats();
+
+    int get_line_bytes() const { return 1 << line_shift; }
+
+    // warm state, used by checkpoints
+    const std::vector<Line>& get_lines() const { return lines; }
+    void set_lines(const std::vector<Line>& values);
+};
+
+#endif
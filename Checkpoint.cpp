@@ -0,0 +1,257 @@
+// file: Checkpoint.cpp
+
+#include "Checkpoint.h"
+
+#include <fstream>
+#include <cstring>
+#include <vector>
+
+static const char MAGIC[8] = { 'C', 'P', 'U', 'S', 'I', 'M', 'C', 'K' };
+static const uint32_t VERSION = 1;
+static const uint32_t PAGE_SIZE = 256;
+
+// section tags
+static const uint32_t TAG_END = 0;
+static const uint32_t TAG_PREDICTOR = 1;
+static const uint32_t TAG_DCACHE = 2;
+
+// all fields are stored little endian
+static void put_u32(std::ostream &out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = (value >> (i * 8)) & 0xFF;
+    }
+    out.write(bytes, 4);
+}
+
+static void put_u64(std::ostream &out, uint64_t value) {
+    put_u32(out, (uint32_t)value);
+    put_u32(out, (uint32_t)(value >> 32));
+}
+
+static bool get_u32(std::istream &in, uint32_t *value) {
+    unsigned char bytes[4];
+    if (!in.read((char *)bytes, 4)) {
+        return false;
+    }
+    *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    return true;
+}
+
+static bool get_u64(std::istream &in, uint64_t *value) {
+    uint32_t low, high;
+    if (!get_u32(in, &low) || !get_u32(in, &high)) {
+        return false;
+    }
+    *value = ((uint64_t)high << 32) | low;
+    return true;
+}
+
+// only valid lines are written, as (index, tag, last use, dirty)
+static void save_cache(std::ostream &out, const Cache &cache) {
+    const std::vector<Cache::Line> &lines = cache.get_lines();
+    uint32_t valid = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        valid += lines[i].valid;
+    }
+    put_u32(out, 8 + valid * 17);
+    put_u32(out, lines.size());
+    put_u32(out, valid);
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!lines[i].valid) {
+            continue;
+        }
+        put_u32(out, i);
+        put_u32(out, lines[i].tag);
+        put_u64(out, lines[i].last_used);
+        out.put(lines[i].dirty ? 1 : 0);
+    }
+}
+
+static bool load_cache(std::istream &in, Cache &cache) {
+    uint32_t count, valid;
+    if (!get_u32(in, &count) || !get_u32(in, &valid)) {
+        return false;
+    }
+    // a checkpoint of a different cache geometry cannot warm this one
+    if (count != cache.get_lines().size() || valid > count) {
+        return false;
+    }
+    Cache::Line empty = { 0, 0, false, false };
+    std::vector<Cache::Line> lines(count, empty);
+    for (uint32_t n = 0; n < valid; n++) {
+        uint32_t index;
+        char dirty;
+        Cache::Line line;
+        if (!get_u32(in, &index) || !get_u32(in, &line.tag) || !get_u64(in, &line.last_used) || !in.get(dirty)) {
+            return false;
+        }
+        if (index >= count) {
+            return false;
+        }
+        line.valid = true;
+        line.dirty = dirty != 0;
+        lines[index] = line;
+    }
+    cache.set_lines(lines);
+    return true;
+}
+
+// 2-bit predictor counters are packed four to a byte
+static void save_predictor(std::ostream &out, const BranchPredictor &predictor) {
+    const std::vector<uint8_t> &counters = predictor.get_counters();
+    std::vector<char> packed((counters.size() + 3) / 4, 0);
+    for (size_t i = 0; i < counters.size(); i++) {
+        packed[i / 4] |= (counters[i] & 3) << ((i % 4) * 2);
+    }
+    put_u32(out, 4 + packed.size());
+    put_u32(out, counters.size());
+    out.write(&packed[0], packed.size());
+}
+
+static bool load_predictor(std::istream &in, BranchPredictor &predictor) {
+    uint32_t count;
+    if (!get_u32(in, &count) || count != predictor.get_counters().size()) {
+        return false;
+    }
+    std::vector<char> packed((count + 3) / 4);
+    if (!packed.empty() && !in.read(&packed[0], packed.size())) {
+        return false;
+    }
+    std::vector<uint8_t> counters(count);
+    for (uint32_t i = 0; i < count; i++) {
+        counters[i] = (packed[i / 4] >> ((i % 4) * 2)) & 3;
+    }
+    predictor.set_counters(counters);
+    return true;
+}
+
+bool save_checkpoint(std::ostream &out, CPU &cpu, uint64_t instructions, OOOCore *core) {
+    out.write(MAGIC, sizeof(MAGIC));
+    put_u32(out, VERSION);
+    put_u64(out, instructions);
+    put_u32(out, cpu.readPC() / 2); // byte address
+    for (int reg = 0; reg < 32; reg++) {
+        put_u32(out, cpu.get_register_value(reg));
+    }
+
+    // data memory, only pages holding a nonzero byte
+    std::vector<char> page(PAGE_SIZE);
+    uint32_t pages = CPU::MEMORY_SIZE / PAGE_SIZE;
+    std::vector<uint32_t> nonzero;
+    for (uint32_t p = 0; p < pages; p++) {
+        for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+            if (cpu.read_memory(p * PAGE_SIZE + i, true) != 0) {
+                nonzero.push_back(p);
+                break;
+            }
+        }
+    }
+    put_u32(out, PAGE_SIZE);
+    put_u32(out, nonzero.size());
+    for (size_t n = 0; n < nonzero.size(); n++) {
+        put_u32(out, nonzero[n]);
+        for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+            page[i] = cpu.read_memory(nonzero[n] * PAGE_SIZE + i, true);
+        }
+        out.write(&page[0], PAGE_SIZE);
+    }
+
+    if (core) {
+        put_u32(out, TAG_PREDICTOR);
+        save_predictor(out, core->get_predictor());
+
+        put_u32(out, TAG_DCACHE);
+        save_cache(out, core->get_dcache());
+    }
+    put_u32(out, TAG_END);
+    return out.good();
+}
+
+bool load_checkpoint(std::istream &in, CPU &cpu, uint64_t *instructions, OOOCore *core) {
+    char magic[8];
+    uint32_t version, pc, page_size, pages;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << "Not a checkpoint file" << std::endl;
+        return false;
+    }
+    if (!get_u32(in, &version) || version != VERSION) {
+        std::cerr << "Unsupported checkpoint version" << std::endl;
+        return false;
+    }
+    if (!get_u64(in, instructions) || !get_u32(in, &pc)) {
+        return false;
+    }
+    cpu.setPC(pc * 2);
+    for (int reg = 0; reg < 32; reg++) {
+        uint32_t value;
+        if (!get_u32(in, &value)) {
+            return false;
+        }
+        cpu.set_register_value(reg, value);
+    }
+
+    // pages not in the file are zero
+    for (uint32_t addr = 0; addr < (uint32_t)CPU::MEMORY_SIZE; addr++) {
+        cpu.write_memory(addr, 0, true);
+    }
+    if (!get_u32(in, &page_size) || !get_u32(in, &pages)) {
+        return false;
+    }
+    // only the layout save_checkpoint writes; anything else is corrupt
+    if (page_size != PAGE_SIZE || pages > CPU::MEMORY_SIZE / PAGE_SIZE) {
+        return false;
+    }
+    std::vector<char> page(PAGE_SIZE);
+    for (uint32_t n = 0; n < pages; n++) {
+        uint32_t index;
+        if (!get_u32(in, &index) || index >= CPU::MEMORY_SIZE / PAGE_SIZE || !in.read(&page[0], PAGE_SIZE)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+            cpu.write_memory(index * PAGE_SIZE + i, page[i], true);
+        }
+    }
+
+    // optional warm state
+    for (;;) {
+        uint32_t tag, length;
+        if (!get_u32(in, &tag)) {
+            return false;
+        }
+        if (tag == TAG_END) {
+            break;
+        }
+        if (!get_u32(in, &length)) {
+            return false;
+        }
+        if (tag == TAG_PREDICTOR && core) {
+            if (!load_predictor(in, core->get_predictor())) {
+                return false;
+            }
+        } else if (tag == TAG_DCACHE && core) {
+            if (!load_cache(in, core->get_dcache())) {
+                return false;
+            }
+        } else {
+            in.ignore(length);
+        }
+    }
+    return true;
+}
+
+bool save_checkpoint(const char *filename, CPU &cpu, uint64_t instructions, OOOCore *core) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    return save_checkpoint(out, cpu, instructions, core);
+}
+
+bool load_checkpoint(const char *filename, CPU &cpu, uint64_t *instructions, OOOCore *core) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    return load_checkpoint(in, cpu, instructions, core);
+}
@@ -0,0 +1,25 @@
+// file: Checkpoint.h
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <iostream>
+#include "CPU.h"
+#include "OOOCore.h"
+
+// Binary architectural checkpoint:
+//   "CPUSIMCK", version, instructions retired, PC, registers,
+//   the nonzero pages of data memory,
+//   then tagged sections of optional warm state (branch predictor, D-cache)
+//   and an end tag.
+// Warm state is written when a timing model is passed and restored into one
+// with the same geometry; otherwise it is skipped.
+
+bool save_checkpoint(std::ostream &out, CPU &cpu, uint64_t instructions, OOOCore *core = NULL);
+bool load_checkpoint(std::istream &in, CPU &cpu, uint64_t *instructions, OOOCore *core = NULL);
+
+bool save_checkpoint(const char *filename, CPU &cpu, uint64_t instructions, OOOCore *core = NULL);
+bool load_checkpoint(const char *filename, CPU &cpu, uint64_t *instructions, OOOCore *core = NULL);
+
+#endif
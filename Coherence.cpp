@@ -0,0 +1,292 @@
+// file: Coherence.cpp
+
+#include "Coherence.h"
+
+#include <algorithm>
+#include <iomanip>
+
+static const uint32_t EMPTY_BLOCK = ~0u;
+static const size_t HOT_LINES = 256;
+
+static int floor_log2(int value) {
+    int bits = 0;
+    while ((2 << bits) <= value) {
+        bits++;
+    }
+    return bits;
+}
+
+CoherenceModel::CoherenceModel(int num_cores, const CoherenceConfig &config)
+    : clock(0), accesses(0), hits(0), misses(0), coherence_misses(0), invalidations(0),
+      false_sharing(0), upgrades(0), interventions(0), writebacks(0) {
+    cores = std::min(std::max(num_cores, 1), MAX_COHERENT_CORES);
+    ways = std::max(config.ways, 1);
+    line_shift = floor_log2(std::max(config.line_bytes, 4));
+    words_per_line = std::min(1 << (line_shift - 2), 64);
+    sets = 1 << floor_log2(std::max((config.cache_size >> line_shift) / ways, 1));
+
+    Line empty = { EMPTY_BLOCK, 0, 0, INVALID, false };
+    lines.assign(cores * sets * ways, empty);
+
+    // at most every cached line of every core is tracked; keep the load <= 1/2
+    size_t capacity = 1;
+    while (capacity < (size_t)cores * sets * ways * 2) {
+        capacity *= 2;
+    }
+    DirEntry unused = { EMPTY_BLOCK, 0 };
+    directory.assign(capacity, unused);
+}
+
+CoherenceModel::Line *CoherenceModel::find(int core, uint32_t block) {
+    Line *set = &lines[(core * sets + (block & (sets - 1))) * ways];
+    for (int way = 0; way < ways; way++) {
+        if (set[way].block == block) {
+            return &set[way];
+        }
+    }
+    return NULL;
+}
+
+// finds a frame for the block in the core's L1, evicting the LRU line if needed
+CoherenceModel::Line *CoherenceModel::allocate(int core, uint32_t block) {
+    Line *set = &lines[(core * sets + (block & (sets - 1))) * ways];
+    Line *victim = &set[0];
+    for (int way = 0; way < ways; way++) {
+        if (set[way].block == block) {
+            return &set[way]; // invalidated copy, reuse its frame
+        }
+        if (set[way].state == INVALID) {
+            if (victim->state != INVALID || set[way].last_used < victim->last_used) {
+                victim = &set[way];
+            }
+        } else if (victim->state != INVALID && set[way].last_used < victim->last_used) {
+            victim = &set[way];
+        }
+    }
+    if (victim->state != INVALID) {
+        if (victim->state == MODIFIED) {
+            writebacks++;
+        }
+        remove_sharer(core, victim->block);
+    }
+    victim->block = block;
+    victim->state = INVALID;
+    victim->invalidated = false;
+    victim->touched = 0;
+    return victim;
+}
+
+static inline size_t hash_block(uint32_t block, size_t mask) {
+    return (block * 0x9E3779B1u) & mask;
+}
+
+CoherenceModel::DirEntry *CoherenceModel::lookup(uint32_t block) {
+    size_t mask = directory.size() - 1;
+    for (size_t i = hash_block(block, mask);; i = (i + 1) & mask) {
+        if (directory[i].block == block) {
+            return &directory[i];
+        }
+        if (directory[i].block == EMPTY_BLOCK) {
+            return NULL;
+        }
+    }
+}
+
+CoherenceModel::DirEntry &CoherenceModel::insert(uint32_t block) {
+    size_t mask = directory.size() - 1;
+    size_t i = hash_block(block, mask);
+    while (directory[i].block != EMPTY_BLOCK && directory[i].block != block) {
+        i = (i + 1) & mask;
+    }
+    if (directory[i].block == EMPTY_BLOCK) {
+        directory[i].block = block;
+        directory[i].sharers = 0;
+    }
+    return directory[i];
+}
+
+// linear probing deletion that shifts later entries back, no tombstones
+void CoherenceModel::erase(uint32_t block) {
+    size_t mask = directory.size() - 1;
+    size_t i = hash_block(block, mask);
+    while (directory[i].block != block) {
+        if (directory[i].block == EMPTY_BLOCK) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; directory[j].block != EMPTY_BLOCK; j = (j + 1) & mask) {
+        size_t home = hash_block(directory[j].block, mask);
+        // move j into the hole unless its home lies cyclically in (hole, j]
+        bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (!stays) {
+            directory[hole] = directory[j];
+            hole = j;
+        }
+    }
+    directory[hole].block = EMPTY_BLOCK;
+    directory[hole].sharers = 0;
+}
+
+void CoherenceModel::remove_sharer(int core, uint32_t block) {
+    DirEntry *entry = lookup(block);
+    if (!entry) {
+        return;
+    }
+    entry->sharers &= ~(1ULL << core);
+    if (entry->sharers == 0) {
+        erase(block);
+    }
+}
+
+void CoherenceModel::invalidate_others(int writer, uint32_t block, int word) {
+    DirEntry *entry = lookup(block);
+    if (!entry) {
+        return;
+    }
+    uint64_t others = entry->sharers & ~(1ULL << writer);
+    for (int core = 0; others; core++, others >>= 1) {
+        if (!(others & 1)) {
+            continue;
+        }
+        Line *line = find(core, block);
+        if (!line || line->state == INVALID) {
+            continue;
+        }
+        if (line->state == MODIFIED) {
+            writebacks++;
+        }
+        // the victim never used the word being written: false sharing
+        bool false_share = !(line->touched & (1ULL << word));
+        line->state = INVALID;
+        line->invalidated = true;
+        invalidations++;
+        if (false_share) {
+            false_sharing++;
+        }
+        record_hot(block, false_share);
+    }
+    entry->sharers &= 1ULL << writer;
+    if (entry->sharers == 0) {
+        erase(block);
+    }
+}
+
+// space-saving top-K: an unseen line replaces the least counted one
+void CoherenceModel::record_hot(uint32_t block, bool false_share) {
+    size_t smallest = 0;
+    for (size_t i = 0; i < hot.size(); i++) {
+        if (hot[i].block == block) {
+            hot[i].invalidations++;
+            hot[i].false_sharing += false_share;
+            return;
+        }
+        if (hot[i].invalidations < hot[smallest].invalidations) {
+            smallest = i;
+        }
+    }
+    if (hot.size() < HOT_LINES) {
+        HotLine line = { block, false_share ? 1ULL : 0ULL, 1 };
+        hot.push_back(line);
+    } else {
+        hot[smallest].block = block;
+        hot[smallest].invalidations++;
+        hot[smallest].false_sharing += false_share;
+    }
+}
+
+void CoherenceModel::access(int core, uint32_t address, bool is_write) {
+    if (core < 0 || core >= cores) {
+        return; // beyond the cores the model was built for
+    }
+    uint32_t block = address >> line_shift;
+    int word = (address >> 2) & (words_per_line - 1);
+    accesses++;
+    clock++;
+
+    Line *line = find(core, block);
+    if (line && line->state != INVALID) {
+        hits++;
+        if (is_write && line->state == SHARED) {
+            upgrades++;
+            invalidate_others(core, block, word);
+            line->state = MODIFIED;
+        } else if (is_write) {
+            line->state = MODIFIED; // E -> M silently
+        }
+    } else {
+        misses++;
+        if (line && line->invalidated) {
+            coherence_misses++;
+        }
+        if (is_write) {
+            invalidate_others(core, block, word);
+        }
+        DirEntry *entry = lookup(block);
+        bool shared = false;
+        if (!is_write && entry) {
+            // other copies drop to SHARED
+            uint64_t others = entry->sharers & ~(1ULL << core);
+            for (int other = 0; others; other++, others >>= 1) {
+                if (!(others & 1)) {
+                    continue;
+                }
+                Line *copy = find(other, block);
+                if (copy && (copy->state == MODIFIED || copy->state == EXCLUSIVE)) {
+                    if (copy->state == MODIFIED) {
+                        writebacks++;
+                    }
+                    copy->state = SHARED;
+                    interventions++;
+                }
+                shared = true;
+            }
+        }
+        line = allocate(core, block);
+        line->state = is_write ? MODIFIED : (shared ? SHARED : EXCLUSIVE);
+        line->invalidated = false;
+        insert(block).sharers |= 1ULL << core;
+    }
+    line->last_used = clock;
+    line->touched |= 1ULL << word;
+}
+
+size_t CoherenceModel::directory_entries() const {
+    size_t used = 0;
+    for (size_t i = 0; i < directory.size(); i++) {
+        used += directory[i].block != EMPTY_BLOCK;
+    }
+    return used;
+}
+
+static bool hotter(const CoherenceModel::HotLine &a, const CoherenceModel::HotLine &b) {
+    if (a.false_sharing != b.false_sharing) {
+        return a.false_sharing > b.false_sharing;
+    }
+    return a.invalidations > b.invalidations;
+}
+
+void CoherenceModel::print_stats(std::ostream &out, int top_lines) const {
+    out << "coherence.accesses " << accesses << std::endl;
+    out << "coherence.hits " << hits << std::endl;
+    out << "coherence.misses " << misses << std::endl;
+    out << "coherence.coherence_misses " << coherence_misses << std::endl;
+    out << "coherence.invalidations " << invalidations << std::endl;
+    out << "coherence.false_sharing " << false_sharing << std::endl;
+    out << "coherence.upgrades " << upgrades << std::endl;
+    out << "coherence.interventions " << interventions << std::endl;
+    out << "coherence.writebacks " << writebacks << std::endl;
+    out << "coherence.directory_entries " << directory_entries() << " / " << directory.size() << std::endl;
+
+    std::vector<HotLine> sorted = hot;
+    std::sort(sorted.begin(), sorted.end(), hotter);
+    for (int i = 0; i < top_lines && i < (int)sorted.size(); i++) {
+        if (sorted[i].false_sharing == 0) {
+            break;
+        }
+        out << "coherence.false_sharing_line 0x" << std::hex << (sorted[i].block << line_shift) << std::dec
+            << " false_sharing " << sorted[i].false_sharing
+            << " invalidations " << sorted[i].invalidations << std::endl;
+    }
+}
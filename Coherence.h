@@ -0,0 +1,89 @@
+// file: Coherence.h
+
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// the sharer set of a directory entry is a 64-bit mask
+static const int MAX_COHERENT_CORES = 64;
+
+struct CoherenceConfig {
+    int cache_size;     // bytes per private L1
+    int ways;
+    int line_bytes;
+
+    CoherenceConfig() : cache_size(16384), ways(4), line_bytes(64) {}
+};
+
+// Timing-side MESI model: one private L1 per core, kept coherent through a
+// directory. The directory is an open-addressed hash table holding only the
+// lines that are cached somewhere, so its size is bounded by the total L1
+// capacity rather than by the memory footprint. Up to 64 cores.
+class CoherenceModel {
+public:
+    enum State { INVALID, SHARED, EXCLUSIVE, MODIFIED };
+
+    struct HotLine {
+        uint32_t block;
+        uint64_t false_sharing;
+        uint64_t invalidations;
+    };
+
+private:
+    struct Line {
+        uint32_t block;
+        uint64_t last_used;
+        uint64_t touched;       // words this core accessed since the fill
+        uint8_t state;
+        bool invalidated;       // lost to another core's write
+    };
+
+    struct DirEntry {
+        uint32_t block;         // EMPTY_BLOCK when unused
+        uint64_t sharers;       // one bit per core holding the line
+    };
+
+    int cores;
+    int sets;
+    int ways;
+    int line_shift;
+    int words_per_line;
+    uint64_t clock;
+    std::vector<Line> lines;            // cores * sets * ways
+    std::vector<DirEntry> directory;    // power of two, at most half full
+    std::vector<HotLine> hot;           // bounded top-K, space-saving
+
+    Line *find(int core, uint32_t block);
+    Line *allocate(int core, uint32_t block);
+    DirEntry *lookup(uint32_t block);
+    DirEntry &insert(uint32_t block);
+    void erase(uint32_t block);
+    void remove_sharer(int core, uint32_t block);
+    void invalidate_others(int writer, uint32_t block, int word);
+    void record_hot(uint32_t block, bool false_sharing);
+
+public:
+    uint64_t accesses;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t coherence_misses;  // misses on lines another core invalidated
+    uint64_t invalidations;
+    uint64_t false_sharing;     // invalidations of lines whose invalidated copy never used the written word
+    uint64_t upgrades;          // S -> M
+    uint64_t interventions;     // M/E copy downgraded by another core's read
+    uint64_t writebacks;
+
+    // cores is clamped to 1..MAX_COHERENT_CORES; accesses of other cores are ignored
+    CoherenceModel(int cores, const CoherenceConfig &config = CoherenceConfig());
+
+    // one load or store; sharing is tracked at word granularity
+    void access(int core, uint32_t address, bool is_write);
+
+    size_t directory_entries() const;
+    void print_stats(std::ostream &out, int top_lines = 8) const;
+};
+
+#endif
@@ -0,0 +1,211 @@
+// file: Differential.cpp
+
+#include "Differential.h"
+#include "CPU.h"
+#include "FastEngine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+// how often (in blocks) the agreeing states are kept for bisection
+static const uint64_t SNAPSHOT_BLOCKS = 1024;
+
+// The reference CPU plus the incremental hash of its architectural state.
+// Shadow copies of the registers and memory words supply the old value
+// of whatever location an instruction wrote.
+struct ReferenceRun {
+    CPU cpu;
+    uint64_t count;
+    bool finished;
+    uint64_t hash;
+    int32_t regs[32];
+    uint32_t words[CPU::MEMORY_SIZE / 4];
+
+    ReferenceRun() : count(0), finished(false), hash(0) {
+        cpu.set_report_faults(false);
+    }
+
+    void load(const FuzzInput &initial) {
+        for (int reg = 1; reg < 32; reg++) {
+            cpu.set_register_value(reg, initial.regs[reg]);
+        }
+        for (int address = 0; address < CPU::MEMORY_SIZE; address++) {
+            if (initial.memory[address]) {
+                cpu.write_memory(address, initial.memory[address], true);
+            }
+        }
+        hash = 0;
+        for (int reg = 0; reg < 32; reg++) {
+            regs[reg] = cpu.get_register_value(reg);
+            hash ^= reg ? state_hash_term(reg, regs[reg]) : 0;
+        }
+        for (int word = 0; word < CPU::MEMORY_SIZE / 4; word++) {
+            words[word] = cpu.read_memory(word * 4, false);
+            hash ^= state_hash_term(32 + word, words[word]);
+        }
+    }
+
+    // same loop body as the main loop in cpusim.cpp
+    void step(Program &program) {
+        RetiredInst retired;
+        bool running = cpu.step(program.instructions(), &retired);
+        if (running) {
+            count++;
+        }
+        if (!running || cpu.readPC() > (unsigned long)program.maxPC * 8) {
+            finished = true;
+        }
+        int32_t value = cpu.get_register_value(retired.rd);
+        if (retired.rd != 0 && value != regs[retired.rd]) {
+            hash ^= state_hash_term(retired.rd, regs[retired.rd]) ^ state_hash_term(retired.rd, value);
+            regs[retired.rd] = value;
+        }
+        if (retired.memWr && retired.mem_address < (uint32_t)CPU::MEMORY_SIZE) {
+            uint32_t word = retired.mem_address / 4;
+            uint32_t stored = cpu.read_memory(word * 4, false);
+            hash ^= state_hash_term(32 + word, words[word]) ^ state_hash_term(32 + word, stored);
+            words[word] = stored;
+        }
+    }
+
+    uint32_t byte_pc() { return cpu.readPC() / 2; }
+};
+
+static uint32_t fast_word(const FastEngine &fast, uint32_t address) {
+    uint32_t word = 0;
+    for (int b = 3; b >= 0; b--) {
+        word = word << 8 | fast.read_byte(address + b);
+    }
+    return word;
+}
+
+static bool same_state(ReferenceRun &ref, const FastEngine &fast) {
+    if (ref.count != fast.get_instructions() || ref.finished != fast.has_finished() ||
+        ref.byte_pc() != fast.get_pc()) {
+        return false;
+    }
+    for (int reg = 1; reg < 32; reg++) {
+        if (ref.cpu.get_register_value(reg) != fast.get_register(reg)) {
+            return false;
+        }
+    }
+    for (uint32_t address = 0; address < (uint32_t)CPU::MEMORY_SIZE; address += 4) {
+        if ((uint32_t)ref.cpu.read_memory(address, false) != fast_word(fast, address)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// advances both copies to `target` instructions (or their end)
+static void run_to(Program &program, ReferenceRun &ref, FastEngine &fast, uint64_t target) {
+    while (ref.count < target && !ref.finished) {
+        ref.step(program);
+    }
+    while (fast.get_instructions() < target && fast.step()) {
+    }
+}
+
+static void report_difference(ReferenceRun &ref, const FastEngine &fast, std::ostream &out) {
+    out << "diff.pc reference 0x" << std::hex << ref.byte_pc() << " fast 0x" << fast.get_pc() << std::dec << std::endl;
+    if (ref.finished != fast.has_finished()) {
+        out << "diff.finished reference " << ref.finished << " fast " << fast.has_finished() << std::endl;
+    }
+    for (int reg = 1; reg < 32; reg++) {
+        if (ref.cpu.get_register_value(reg) != fast.get_register(reg)) {
+            out << "diff.x" << reg << " reference " << ref.cpu.get_register_value(reg)
+                << " fast " << fast.get_register(reg) << std::endl;
+        }
+    }
+    for (uint32_t address = 0; address < (uint32_t)CPU::MEMORY_SIZE; address += 4) {
+        uint32_t expected = ref.cpu.read_memory(address, false);
+        if (expected != fast_word(fast, address)) {
+            out << "diff.mem[0x" << std::hex << address << "] reference 0x" << expected
+                << " fast 0x" << fast_word(fast, address) << std::dec << std::endl;
+        }
+    }
+}
+
+DifferentialResult run_differential(Program &program, const DecodedProgram &decoded, const FuzzInput &initial,
+                                    uint64_t max_instructions, std::ostream &out) {
+    DifferentialResult result = { false, 0, 0, 0 };
+    ReferenceRun *ref = new ReferenceRun();
+    FastEngine *fast = new FastEngine(decoded);
+    fast->track_state_hash();
+    ref->load(initial);
+    for (int reg = 1; reg < 32; reg++) {
+        fast->set_register(reg, initial.regs[reg]);
+    }
+    for (int address = 0; address < CPU::MEMORY_SIZE; address++) {
+        fast->write_byte(address, initial.memory[address]);
+    }
+
+    // last states known to agree, and how many instructions they had run
+    ReferenceRun *good_ref = new ReferenceRun(*ref);
+    FastEngine good_fast(*fast);
+
+    bool running = true;
+    while (running) {
+        running = fast->run_block(max_instructions);
+        run_to(program, *ref, *fast, fast->get_instructions());
+        if (!running && !ref->finished && fast->has_finished()) {
+            ref->step(program); // the reference only notices the end by stepping into it
+        }
+        result.blocks++;
+        bool agree = ref->hash == fast->state_hash() && ref->count == fast->get_instructions() &&
+                     ref->finished == fast->has_finished() && ref->byte_pc() == fast->get_pc();
+        if (!agree) {
+            result.diverged = true;
+            break;
+        }
+        result.instructions = fast->get_instructions();
+        if (result.blocks % SNAPSHOT_BLOCKS == 0) {
+            *good_ref = *ref;
+            good_fast = *fast;
+        }
+    }
+
+    if (!result.diverged) {
+        out << "diff.result match" << std::endl;
+        out << "diff.instructions " << result.instructions << std::endl;
+        out << "diff.blocks " << result.blocks << std::endl;
+        out << "diff.state_hash 0x" << std::hex << fast->state_hash() << std::dec << std::endl;
+    } else {
+        // bisect between the last agreeing snapshot and the divergent block
+        uint64_t low = good_ref->count;
+        uint64_t high = std::max(ref->count, fast->get_instructions()) + 1;
+        while (high - low > 1) {
+            uint64_t middle = low + (high - low) / 2;
+            ReferenceRun *probe_ref = new ReferenceRun(*good_ref);
+            FastEngine probe_fast(good_fast);
+            run_to(program, *probe_ref, probe_fast, middle);
+            if (same_state(*probe_ref, probe_fast)) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+            delete probe_ref;
+        }
+        result.first_divergent = high;
+
+        // show the state just after the divergent instruction
+        ReferenceRun *probe_ref = new ReferenceRun(*good_ref);
+        FastEngine probe_fast(good_fast);
+        run_to(program, *probe_ref, probe_fast, low);
+        uint32_t pc = probe_fast.get_pc();
+        const DecodedInst *inst = decoded.at(pc);
+        run_to(program, *probe_ref, probe_fast, high);
+
+        out << "diff.result diverged" << std::endl;
+        out << "diff.instruction " << high << std::endl;
+        out << "diff.at_pc 0x" << std::hex << pc << " word 0x" << std::setw(8) << std::setfill('0')
+            << (inst ? inst->word : 0) << std::setfill(' ') << std::dec << std::endl;
+        report_difference(*probe_ref, probe_fast, out);
+        delete probe_ref;
+    }
+    delete good_ref;
+    delete ref;
+    delete fast;
+    return result;
+}
@@ -0,0 +1,27 @@
+// file: Differential.h
+
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+#include <cstdint>
+#include <iostream>
+#include "Fuzzer.h"
+#include "Predecode.h"
+#include "Program.h"
+
+struct DifferentialResult {
+    bool diverged;
+    uint64_t instructions;      // executed by both engines while they agreed
+    uint64_t blocks;            // boundaries at which the state hashes were compared
+    uint64_t first_divergent;   // 1-based index of the first instruction whose effects differ
+};
+
+// Runs the reference CPU::step path and the pre-decoded FastEngine from the
+// same initial state. After every basic block the engines' incremental
+// state hashes, PCs and instruction counts are compared; on a mismatch the
+// last agreeing snapshot is re-run under bisection to find the exact
+// instruction, and the differing registers and memory words are reported.
+DifferentialResult run_differential(Program &program, const DecodedProgram &decoded, const FuzzInput &initial,
+                                    uint64_t max_instructions, std::ostream &out);
+
+#endif
@@ -0,0 +1,89 @@
+// file: Engines.cpp
+
+#include "Engines.h"
+#include "CPU.h"
+#include "FastEngine.h"
+#include "Instrumentation.h"
+#include "LiveStats.h"
+
+template <class Policy>
+static EngineResult run_reference(Program &program, const DecodedProgram &, uint64_t max_instructions,
+                                  std::ostream &out, LiveStats *live) {
+    Policy policy(out);
+    CPU cpu;
+    EngineResult result = { 0, 0, 0, true };
+    bool done = true;
+    while (done) {
+        if (max_instructions && result.instructions >= max_instructions) {
+            result.finished = false;
+            break;
+        }
+        unsigned long pc = cpu.readPC();
+        done = cpu.step(program.instructions(), policy);
+        if (done) {
+            result.instructions++;
+        }
+        if (live && cpu.readPC() != pc + 8) {
+            live->publish(result.instructions, NULL);
+        }
+        if (cpu.readPC() > (unsigned long)program.maxPC * 8) {
+            break;
+        }
+    }
+    if (live) {
+        live->finish(result.instructions, NULL);
+    }
+    result.a0 = cpu.get_register_value(10);
+    result.a1 = cpu.get_register_value(11);
+    policy.report(out);
+    return result;
+}
+
+template <class Policy>
+static EngineResult run_fast(Program &, const DecodedProgram &decoded, uint64_t max_instructions,
+                             std::ostream &out, LiveStats *live) {
+    Policy policy(out);
+    FastEngine engine(decoded);
+    while (!max_instructions || engine.get_instructions() < max_instructions) {
+        uint32_t pc = engine.get_pc();
+        if (!engine.step(policy)) {
+            break;
+        }
+        if (live && engine.get_pc() != pc + 4) {
+            live->publish(engine.get_instructions(), NULL);
+        }
+    }
+    if (live) {
+        live->finish(engine.get_instructions(), NULL);
+    }
+    EngineResult result = { engine.get_register(10), engine.get_register(11), engine.get_instructions(),
+                            engine.has_finished() };
+    policy.report(out);
+    return result;
+}
+
+struct EngineEntry {
+    const char *engine;
+    const char *instrumentation;
+    EngineFunction run;
+};
+
+static const EngineEntry ENGINES[] = {
+    { "reference", "none", run_reference<NoInstrumentation> },
+    { "reference", "counters", run_reference<CountingInstrumentation> },
+    { "reference", "trace", run_reference<TraceInstrumentation> },
+    { "reference", "binary", run_reference<BinaryTraceInstrumentation> },
+    { "fast", "none", run_fast<NoInstrumentation> },
+    { "fast", "counters", run_fast<CountingInstrumentation> },
+    { "fast", "trace", run_fast<TraceInstrumentation> },
+    { "fast", "binary", run_fast<BinaryTraceInstrumentation> },
+};
+
+EngineFunction select_engine(const std::string &engine, const std::string &instrumentation) {
+    for (size_t i = 0; i < sizeof(ENGINES) / sizeof(ENGINES[0]); i++) {
+        if (engine == ENGINES[i].engine && instrumentation == ENGINES[i].instrumentation) {
+            return ENGINES[i].run;
+        }
+    }
+    return NULL;
+}
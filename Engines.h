@@ -0,0 +1,33 @@
+// file: Engines.h
+
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "Predecode.h"
+#include "Program.h"
+
+class LiveStats;
+
+struct EngineResult {
+    int32_t a0;
+    int32_t a1;
+    uint64_t instructions;
+    bool finished;          // false if max_instructions stopped the run
+};
+
+// One run of a program from the zeroed machine. `out` receives the trace
+// or the counter report of the instrumentation policy; `live`, if not
+// NULL, is published at every basic block boundary and finished at the end.
+typedef EngineResult (*EngineFunction)(Program &program, const DecodedProgram &decoded,
+                                       uint64_t max_instructions, std::ostream &out, LiveStats *live);
+
+// Every engine is instantiated once per instrumentation policy at compile
+// time; this picks one at run time. Engines are "reference" (CPU::step)
+// and "fast" (FastEngine); instrumentation is "none", "counters",
+// "trace" or "binary". Returns NULL for unknown names.
+EngineFunction select_engine(const std::string &engine, const std::string &instrumentation);
+
+#endif
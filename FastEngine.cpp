@@ -0,0 +1,206 @@
+// file: FastEngine.cpp
+
+#include "FastEngine.h"
+#include "ALU.h"
+
+#include <cstring>
+
+uint64_t state_hash_term(uint32_t location, uint32_t value) {
+    if (value == 0) {
+        return 0;
+    }
+    // splitmix64 finalizer
+    uint64_t x = ((uint64_t)location << 32 | value) + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+FastEngine::FastEngine(const DecodedProgram &prog)
+    : program(&prog), pc(0), count(0), finished(false), reservation_valid(false), reservation_address(0),
+      hashing(false), hash(0) {
+    memset(regs, 0, sizeof(regs));
+    memset(memory, 0, sizeof(memory));
+}
+
+void FastEngine::write_register(int reg, int32_t value) {
+    if (reg > 0 && reg < 32) {
+        if (hashing) {
+            hash ^= state_hash_term(reg, regs[reg]) ^ state_hash_term(reg, value);
+        }
+        regs[reg] = value;
+    }
+}
+
+int32_t FastEngine::read_word(uint32_t address) const {
+    if (address >= (uint32_t)MEMORY_SIZE || address % 4 != 0) {
+        return 0;
+    }
+    int32_t word;
+    memcpy(&word, &memory[address], 4);
+    return word;
+}
+
+void FastEngine::write_word(uint32_t address, int32_t value) {
+    if (address >= (uint32_t)MEMORY_SIZE || address % 4 != 0) {
+        return;
+    }
+    if (hashing) {
+        uint32_t old = read_word(address);
+        hash ^= state_hash_term(32 + address / 4, old) ^ state_hash_term(32 + address / 4, value);
+    }
+    memcpy(&memory[address], &value, 4);
+}
+
+void FastEngine::track_state_hash() {
+    hash = state_hash();
+    hashing = true;
+}
+
+uint64_t FastEngine::state_hash() const {
+    if (hashing) {
+        return hash;
+    }
+    uint64_t full = 0;
+    for (int reg = 1; reg < 32; reg++) {
+        full ^= state_hash_term(reg, regs[reg]);
+    }
+    for (uint32_t address = 0; address < (uint32_t)MEMORY_SIZE; address += 4) {
+        full ^= state_hash_term(32 + address / 4, read_word(address));
+    }
+    return full;
+}
+
+void FastEngine::write_memory_byte(uint32_t address, uint8_t value) {
+    if (address >= (uint32_t)MEMORY_SIZE) {
+        return;
+    }
+    uint32_t aligned = address & ~3u;
+    uint32_t word = read_word(aligned);
+    int shift = (address & 3) * 8;
+    write_word(aligned, (word & ~(0xFFu << shift)) | ((uint32_t)value << shift));
+}
+
+bool FastEngine::step() {
+    const DecodedInst *inst = program->at(pc);
+    if (finished || pc > program->end_pc || !inst) {
+        finished = true;
+        return false;
+    }
+    if (inst->end) {
+        // CPU::step still moves past the NULL instruction
+        pc += 4;
+        finished = true;
+        return false;
+    }
+    int32_t rs1 = regs[inst->rs1];
+    int32_t rs2 = regs[inst->rs2];
+    uint32_t next = pc + 4;
+
+    switch (inst->opcode) {
+        case 0x33: write_register(inst->rd, alu_result(rs1, rs2, inst->aluOp)); break;
+        case 0x13: write_register(inst->rd, alu_result(rs1, inst->imm, inst->aluOp)); break;
+        case 0x37: write_register(inst->rd, inst->imm); break;
+        case 0x63:
+            if (rs1 == rs2) {
+                next = pc + inst->imm;
+            }
+            break;
+        case 0x6F:
+            write_register(inst->rd, pc + 4);
+            next = pc + inst->imm;
+            break;
+        case 0x03: {
+            uint32_t address = (uint32_t)rs1 + (uint32_t)inst->imm;
+            if (inst->aluOp == 0x8) {
+                write_register(inst->rd, (int8_t)read_byte(address));
+            } else if (inst->aluOp == 0x9) {
+                write_register(inst->rd, read_word(address));
+            }
+            break;
+        }
+        case 0x23: {
+            uint32_t address = (uint32_t)rs1 + (uint32_t)inst->imm;
+            if (inst->aluOp == 0xA) {
+                write_memory_byte(address, rs2 & 0xFF);
+            } else if (inst->aluOp == 0xB) {
+                write_word(address, rs2);
+            }
+            break;
+        }
+        case 0x2F: {
+            uint32_t address = (uint32_t)rs1;
+            int funct5 = inst->funct7 >> 2;
+            int32_t result = 0;
+            if (address < (uint32_t)MEMORY_SIZE && address % 4 == 0) {
+                int32_t old = read_word(address);
+                if (funct5 == 0x02) { // LR.W
+                    reservation_valid = true;
+                    reservation_address = address;
+                    result = old;
+                } else if (funct5 == 0x03) { // SC.W, 0 on success
+                    bool success = reservation_valid && reservation_address == address;
+                    reservation_valid = false;
+                    if (success) {
+                        write_word(address, rs2);
+                    }
+                    result = success ? 0 : 1;
+                } else {
+                    write_word(address, ALU::atomic_result(funct5, old, rs2));
+                    result = old;
+                }
+            }
+            write_register(inst->rd, result);
+            break;
+        }
+        default:
+            break;
+    }
+    pc = next;
+    count++;
+    if (pc > program->end_pc) {
+        finished = true;
+    }
+    return true;
+}
+
+bool FastEngine::run_block(uint64_t max_instructions) {
+    while (!max_instructions || count < max_instructions) {
+        const DecodedInst *inst = program->at(pc);
+        bool ends_block = inst && (inst->opcode == 0x63 || inst->opcode == 0x6F);
+        if (!step()) {
+            return false;
+        }
+        if (ends_block) {
+            break;
+        }
+    }
+    return !finished;
+}
+
+uint64_t FastEngine::run(uint64_t max_instructions) {
+    uint64_t start = count;
+    while ((!max_instructions || count < max_instructions) && step()) {
+    }
+    return count - start;
+}
+
+uint64_t FastEngine::run_profiled(uint64_t max_instructions, uint64_t *block_entries) {
+    uint64_t start = count;
+    while (!finished && (!max_instructions || count < max_instructions)) {
+        const DecodedInst *inst = program->at(pc);
+        if (!inst) {
+            finished = true;
+            break;
+        }
+        // a block is left only through its last instruction
+        block_entries[pc >> 2]++;
+        uint64_t length = inst->block_length ? inst->block_length : 1;
+        if (max_instructions && count + length > max_instructions) {
+            length = max_instructions - count;
+        }
+        for (uint64_t i = 0; i < length && step(); i++) {
+        }
+    }
+    return count - start;
+}
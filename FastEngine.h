@@ -0,0 +1,107 @@
+// file: FastEngine.h
+
+#ifndef FAST_ENGINE_H
+#define FAST_ENGINE_H
+
+#include <cstdint>
+#include "CPU.h"
+#include "Predecode.h"
+
+// hash contribution of one architectural location (registers 0-31, then
+// memory words from 32); zero values contribute nothing, so a zeroed
+// machine hashes to 0 and the hash can be updated with two XORs per write
+uint64_t state_hash_term(uint32_t location, uint32_t value);
+
+// Scalar interpreter over a pre-decoded program with the same
+// architectural behaviour as CPU::step: out-of-range and unaligned
+// accesses read 0 and store nothing, x0 is never written.
+class FastEngine {
+public:
+    static const int MEMORY_SIZE = 4096;
+
+private:
+    const DecodedProgram *program;  // a pointer so snapshots can be assigned
+    int32_t regs[32];
+    uint8_t memory[MEMORY_SIZE];
+    uint32_t pc;                // byte address
+    uint64_t count;
+    bool finished;
+    bool reservation_valid;
+    uint32_t reservation_address;
+    bool hashing;               // hash is kept up to date (track_state_hash)
+    uint64_t hash;              // XOR of state_hash_term over the whole state
+
+    void write_register(int reg, int32_t value);
+    int32_t read_word(uint32_t address) const;
+    void write_word(uint32_t address, int32_t value);
+    void write_memory_byte(uint32_t address, uint8_t value);
+
+public:
+    explicit FastEngine(const DecodedProgram &program);
+
+    // executes one instruction; false once the program has ended
+    bool step();
+    // step() reporting to an instrumentation policy (see Instrumentation.h)
+    template <class Policy>
+    bool step(Policy &policy);
+    // runs to the end of the current basic block (after a BEQ or JAL), the
+    // program end or max_instructions total (0 = no limit); false once ended
+    bool run_block(uint64_t max_instructions);
+    // runs to the end; returns the number of instructions executed
+    uint64_t run(uint64_t max_instructions);
+    // like run(), bumping block_entries[slot of the leader] once per basic
+    // block entered instead of counting every instruction
+    uint64_t run_profiled(uint64_t max_instructions, uint64_t *block_entries);
+
+    int32_t get_register(int reg) const { return regs[reg]; }
+    void set_register(int reg, int32_t value) { write_register(reg, value); }
+    uint8_t read_byte(uint32_t address) const { return address < (uint32_t)MEMORY_SIZE ? memory[address] : 0; }
+    void write_byte(uint32_t address, uint8_t value) { write_memory_byte(address, value); }
+    uint32_t get_pc() const { return pc; }
+    uint64_t get_instructions() const { return count; }
+    bool has_finished() const { return finished; }
+    // keeps the state hash up to date from now on, two hash terms per
+    // write; for callers that compare hashes often (the differential checker)
+    void track_state_hash();
+    // computed from the whole state unless tracked
+    uint64_t state_hash() const;
+};
+
+template <class Policy>
+inline bool FastEngine::step(Policy &policy) {
+    if (!Policy::enabled) {
+        return step();
+    }
+    uint32_t old_pc = pc;
+    const DecodedInst *inst = program->at(pc);
+    int32_t base = inst ? regs[inst->rs1] : 0;
+    int32_t operand = inst ? regs[inst->rs2] : 0;
+    if (!step()) {
+        return false;
+    }
+    RetiredInst retired;
+    retired.pc = old_pc;
+    retired.inst = inst->word;
+    retired.opcode = inst->opcode;
+    retired.rd = inst->rd;
+    retired.rs1 = inst->rs1;
+    retired.rs2 = inst->rs2;
+    retired.aluOp = inst->aluOp;
+    retired.memRe = inst->opcode == 0x03 || inst->opcode == 0x2F;
+    retired.memWr = inst->opcode == 0x23 || inst->opcode == 0x2F;
+    retired.regWrite = inst->rd != 0 && (inst->opcode == 0x33 || inst->opcode == 0x13 || inst->opcode == 0x03 ||
+                                         inst->opcode == 0x6F || inst->opcode == 0x37 || inst->opcode == 0x2F);
+    retired.branch = inst->opcode == 0x63 || inst->opcode == 0x6F;
+    retired.taken = pc != old_pc + 4;
+    retired.mem_address = inst->opcode == 0x2F ? (uint32_t)base : (uint32_t)base + (uint32_t)inst->imm;
+    retired.result = regs[inst->rd];
+    if (inst->opcode == 0x03) {
+        retired.mem_value = inst->aluOp == 0x8 ? (int8_t)read_byte(retired.mem_address) : read_word(retired.mem_address);
+    } else {
+        retired.mem_value = inst->opcode == 0x23 && inst->aluOp == 0xA ? (operand & 0xFF) : operand;
+    }
+    policy.retire(retired);
+    return true;
+}
+
+#endif
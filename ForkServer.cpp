@@ -0,0 +1,116 @@
+// file: ForkServer.cpp
+
+#include "ForkServer.h"
+#include "FastEngine.h"
+#include "Fuzzer.h"
+
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// written by the child, read by the parent once the child has exited
+struct ChildResult {
+    int status;         // 0 ok, 1 limit, 2 bad input
+    int32_t a0;
+    int32_t a1;
+    uint64_t instructions;
+};
+
+static const char *STATUS_NAMES[] = { "ok", "limit", "bad-input" };
+
+static void run_request(FastEngine &engine, const std::string &line, uint64_t max_instructions,
+                        ChildResult *result) {
+    FuzzInput initial;
+    if (!parse_fuzz_input(line, initial)) {
+        result->status = 2;
+        return;
+    }
+    for (int reg = 1; reg < 32; reg++) {
+        engine.set_register(reg, initial.regs[reg]);
+    }
+    for (int address = 0; address < FastEngine::MEMORY_SIZE; address++) {
+        if (initial.memory[address]) {
+            engine.write_byte(address, initial.memory[address]);
+        }
+    }
+    engine.run(max_instructions);
+    result->a0 = engine.get_register(10);
+    result->a1 = engine.get_register(11);
+    result->instructions = engine.get_instructions();
+    result->status = engine.has_finished() ? 0 : 1;
+}
+
+static void write_result(const ChildResult &result, std::ostream &out) {
+    if (result.status == 2) {
+        out << "bad-input,0,0,0\n";
+    } else {
+        out << STATUS_NAMES[result.status] << "," << result.a0 << "," << result.a1 << ","
+            << result.instructions << "\n";
+    }
+}
+
+// snapshot restore without fork: the request runs on a copy of the initial state
+static void serve_in_process(const FastEngine &snapshot, uint64_t max_instructions, std::istream &in,
+                             std::ostream &out, ForkServerStats &stats) {
+    ChildResult result;
+    std::string line;
+    while (std::getline(in, line)) {
+        stats.requests++;
+        FastEngine engine(snapshot);
+        run_request(engine, line, max_instructions, &result);
+        write_result(result, out);
+        out.flush();
+    }
+}
+
+ForkServerStats run_fork_server(const DecodedProgram &program, uint64_t max_instructions, bool use_fork,
+                                std::istream &in, std::ostream &out) {
+    ForkServerStats stats = { 0, 0 };
+    if (max_instructions == 0) {
+        max_instructions = FORK_SERVER_DEFAULT_MAX_INSTRUCTIONS;
+    }
+    FastEngine snapshot(program);
+    if (!use_fork) {
+        out << "ready" << std::endl;
+        serve_in_process(snapshot, max_instructions, in, out, stats);
+        return stats;
+    }
+
+    ChildResult *result = (ChildResult *)mmap(NULL, sizeof(ChildResult), PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED) {
+        out << "error mapping result page" << std::endl;
+        return stats;
+    }
+
+    out << "ready" << std::endl;
+    std::string line;
+    while (std::getline(in, line)) {
+        stats.requests++;
+        result->status = -1;
+        out.flush(); // the child must not inherit unwritten output
+
+        pid_t child = fork();
+        if (child == 0) {
+            run_request(snapshot, line, max_instructions, result);
+            _exit(0);
+        }
+        if (child < 0) {
+            out << "error forking" << std::endl;
+            break;
+        }
+
+        int wait_status = 0;
+        waitpid(child, &wait_status, 0);
+        if (WIFSIGNALED(wait_status) || result->status < 0) {
+            stats.crashes++;
+            out << "crash,0,0,0\n";
+        } else {
+            write_result(*result, out);
+        }
+        out.flush();
+    }
+    munmap(result, sizeof(ChildResult));
+    return stats;
+}
@@ -0,0 +1,31 @@
+// file: ForkServer.h
+
+#ifndef FORK_SERVER_H
+#define FORK_SERVER_H
+
+#include <cstdint>
+#include <iostream>
+#include "Predecode.h"
+
+// limit for runs when max_instructions is 0, so a looping input answers
+// "limit" instead of blocking the server
+static const uint64_t FORK_SERVER_DEFAULT_MAX_INSTRUCTIONS = 100000000;
+
+struct ForkServerStats {
+    uint64_t requests;
+    uint64_t crashes;   // children that died on a signal
+};
+
+// Serves many runs of one pre-decoded program from a single process. The
+// initial FastEngine state is built once; every request line on `in` forks
+// a copy-on-write child that applies the line's "xN=", "bADDR=" and
+// "wADDR=" tokens (parse_fuzz_input), runs to completion or
+// max_instructions (0 = FORK_SERVER_DEFAULT_MAX_INSTRUCTIONS) and exits.
+// One "status,a0,a1,instructions" line is written to `out` per request,
+// status being ok, limit, bad-input or crash. "ready" is written first.
+// With use_fork false each request instead runs on an in-process copy of
+// the initial state: no crash isolation, but no fork cost either.
+ForkServerStats run_fork_server(const DecodedProgram &program, uint64_t max_instructions, bool use_fork,
+                                std::istream &in, std::ostream &out);
+
+#endif
@@ -0,0 +1,348 @@
+// file: Fuzzer.cpp
+
+#include "Fuzzer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+
+FuzzInput::FuzzInput() : memory(CPU::MEMORY_SIZE, 0) {
+    memset(regs, 0, sizeof(regs));
+}
+
+std::string FuzzInput::to_string() const {
+    std::stringstream out;
+    for (int reg = 1; reg < 32; reg++) {
+        if (regs[reg]) {
+            out << "x" << reg << "=" << regs[reg] << " ";
+        }
+    }
+    for (size_t address = 0; address < memory.size(); address++) {
+        if (memory[address]) {
+            out << "b" << address << "=" << (int)memory[address] << " ";
+        }
+    }
+    std::string line = out.str();
+    if (!line.empty()) {
+        line.erase(line.size() - 1);
+    }
+    return line;
+}
+
+bool parse_fuzz_input(const std::string &line, FuzzInput &input) {
+    std::stringstream tokens(line);
+    std::string token;
+    while (tokens >> token) {
+        size_t equals = token.find('=');
+        if (equals == std::string::npos || equals < 2) {
+            return false;
+        }
+        long location = strtol(token.c_str() + 1, NULL, 0);
+        long value = strtol(token.c_str() + equals + 1, NULL, 0);
+        if (token[0] == 'x' && location > 0 && location < 32) {
+            input.regs[location] = value;
+        } else if (token[0] == 'b' && location >= 0 && location < CPU::MEMORY_SIZE) {
+            input.memory[location] = value & 0xFF;
+        } else if (token[0] == 'w' && location >= 0 && location + 4 <= CPU::MEMORY_SIZE) {
+            for (int b = 0; b < 4; b++) {
+                input.memory[location + b] = (value >> (b * 8)) & 0xFF;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// AFL hit count buckets: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+
+static uint8_t BUCKETS[256];
+
+static void init_buckets() {
+    for (int count = 0; count < 256; count++) {
+        uint8_t bucket = 0;
+        if (count == 1) bucket = 1;
+        else if (count == 2) bucket = 2;
+        else if (count == 3) bucket = 4;
+        else if (count <= 7 && count) bucket = 8;
+        else if (count <= 15 && count) bucket = 16;
+        else if (count <= 31 && count) bucket = 32;
+        else if (count <= 127 && count) bucket = 64;
+        else if (count) bucket = 128;
+        BUCKETS[count] = bucket;
+    }
+}
+
+// bucketizes the trace in place; true if it has a bit still set in virgin
+static bool classify_and_check(uint8_t *trace, const uint8_t *virgin) {
+    bool fresh = false;
+    for (int i = 0; i < CPU::COVERAGE_SIZE / 8; i++) {
+        // memcpy keeps the word loads free of aliasing UB; it compiles to one load
+        uint64_t word;
+        memcpy(&word, trace + i * 8, 8);
+        if (!word) {
+            continue;
+        }
+        for (int b = i * 8; b < i * 8 + 8; b++) {
+            trace[b] = BUCKETS[trace[b]];
+        }
+        uint64_t virgin_word;
+        memcpy(&word, trace + i * 8, 8);
+        memcpy(&virgin_word, virgin + i * 8, 8);
+        fresh = fresh || (word & virgin_word);
+    }
+    return fresh;
+}
+
+// clears the trace's bits from virgin; true if any were still set
+static bool merge_virgin(const uint8_t *trace, uint8_t *virgin) {
+    bool fresh = false;
+    for (int i = 0; i < CPU::COVERAGE_SIZE; i++) {
+        if (trace[i] & virgin[i]) {
+            virgin[i] &= ~trace[i];
+            fresh = true;
+        }
+    }
+    return fresh;
+}
+
+// xorshift64*, one per worker
+struct FuzzRandom {
+    uint64_t state;
+    explicit FuzzRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+    uint32_t below(uint32_t bound) { return (uint32_t)(next() % bound); }
+};
+
+static const int32_t INTERESTING[] = { 0, 1, -1, 2, 4, 16, 127, 128, 255, 256, 1024, 4095, 4096, 0x7FFFFFFF,
+                                       (int32_t)0x80000000 };
+static const int NUM_INTERESTING = sizeof(INTERESTING) / sizeof(INTERESTING[0]);
+
+static void mutate(FuzzInput &input, const FuzzInput &other, uint32_t window, FuzzRandom &random) {
+    int rounds = 1 << random.below(4);
+    for (int round = 0; round < rounds; round++) {
+        uint32_t address = random.below(window);
+        int reg = 1 + random.below(31);
+        switch (random.below(9)) {
+            case 0: input.memory[address] ^= 1 << random.below(8); break;
+            case 1: input.memory[address] = (uint8_t)random.next(); break;
+            case 2: input.memory[address] += (int)random.below(35) - 17; break;
+            case 3: input.memory[address] = (uint8_t)INTERESTING[random.below(NUM_INTERESTING)]; break;
+            case 4: {
+                int32_t value = INTERESTING[random.below(NUM_INTERESTING)];
+                address &= ~3u;
+                if (address + 4 > (uint32_t)CPU::MEMORY_SIZE) {
+                    break;
+                }
+                for (int b = 0; b < 4; b++) {
+                    input.memory[address + b] = (value >> (b * 8)) & 0xFF;
+                }
+                break;
+            }
+            case 5: input.regs[reg] ^= 1 << random.below(32); break;
+            case 6: input.regs[reg] = INTERESTING[random.below(NUM_INTERESTING)]; break;
+            case 7: input.regs[reg] += (int)random.below(35) - 17; break;
+            default: {
+                // splice a block of memory from another corpus entry
+                uint32_t length = 1 + random.below(64);
+                if (address + length > (uint32_t)CPU::MEMORY_SIZE) {
+                    length = CPU::MEMORY_SIZE - address;
+                }
+                memcpy(&input.memory[address], &other.memory[address], length);
+                break;
+            }
+        }
+    }
+}
+
+class FuzzSession {
+private:
+    Program &program;
+    const FuzzConfig &config;
+    std::mutex lock;                    // guards corpus, virgin maps and files
+    std::vector<FuzzInput> corpus;
+    std::vector<uint8_t> virgin;        // AFL convention: bits still unseen are 1
+    std::vector<uint8_t> virgin_faults;
+    std::atomic<uint64_t> next_execution;
+    std::atomic<uint64_t> faulting;
+    std::atomic<uint64_t> hangs;
+    uint64_t saved_faults;
+
+    void save(const char *kind, uint64_t id, const FuzzInput &input) {
+        if (config.output_dir.empty()) {
+            return;
+        }
+        std::stringstream name;
+        name << config.output_dir << "/" << kind << "/id_" << id << ".txt";
+        std::ofstream file(name.str().c_str());
+        file << input.to_string() << "\n";
+    }
+
+public:
+    FuzzSession(Program &prog, const FuzzConfig &cfg)
+        : program(prog), config(cfg), virgin(CPU::COVERAGE_SIZE, 0xFF), virgin_faults(CPU::COVERAGE_SIZE, 0xFF),
+          next_execution(0), faulting(0), hangs(0), saved_faults(0) {}
+
+    // runs one input; trace holds its bucketized edge counts afterwards
+    bool execute(const FuzzInput &input, uint8_t *trace) {
+        memset(trace, 0, CPU::COVERAGE_SIZE);
+        CPU cpu;
+        cpu.set_report_faults(false);
+        cpu.attach_coverage(trace);
+        for (int reg = 1; reg < 32; reg++) {
+            cpu.set_register_value(reg, input.regs[reg]);
+        }
+        for (int address = 0; address < CPU::MEMORY_SIZE; address++) {
+            if (input.memory[address]) {
+                cpu.write_memory(address, input.memory[address], true);
+            }
+        }
+        uint64_t count = 0;
+        bool done = true;
+        bool hung = false;
+        while (done) {
+            if (count >= config.max_instructions) {
+                hung = true;
+                break;
+            }
+            done = cpu.step(program.instructions());
+            if (done) {
+                count++;
+            }
+            if (cpu.readPC() > (unsigned long)program.maxPC * 8) {
+                break;
+            }
+        }
+        if (hung) {
+            hangs++;
+        }
+        return cpu.get_faults() != 0;
+    }
+
+    // keeps the input if it reached new coverage; faulting inputs are
+    // tracked against their own map like AFL's unique crashes
+    void consider(const FuzzInput &input, uint8_t *trace, bool faulted, uint8_t *local_virgin) {
+        bool fresh = classify_and_check(trace, local_virgin);
+        if (!fresh && !faulted) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        if (faulted) {
+            faulting++;
+            if (merge_virgin(trace, &virgin_faults[0])) {
+                save("faults", saved_faults++, input);
+            }
+        }
+        if (fresh && merge_virgin(trace, &virgin[0])) {
+            save("queue", corpus.size(), input);
+            corpus.push_back(input);
+        }
+        memcpy(local_virgin, &virgin[0], CPU::COVERAGE_SIZE);
+    }
+
+    void add_seed(const FuzzInput &input, uint8_t *trace, uint8_t *local_virgin) {
+        bool faulted = execute(input, trace);
+        classify_and_check(trace, local_virgin);
+        std::lock_guard<std::mutex> guard(lock);
+        if (faulted) {
+            faulting++;
+        }
+        merge_virgin(trace, &virgin[0]);
+        save("queue", corpus.size(), input);
+        corpus.push_back(input);
+        memcpy(local_virgin, &virgin[0], CPU::COVERAGE_SIZE);
+    }
+
+    void worker(int id) {
+        FuzzRandom random(config.seed + id);
+        std::vector<uint8_t> trace(CPU::COVERAGE_SIZE);
+        std::vector<uint8_t> local_virgin(CPU::COVERAGE_SIZE);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            local_virgin = virgin;
+        }
+        uint32_t window = config.memory_window;
+        if (window < 1 || window > (uint32_t)CPU::MEMORY_SIZE) {
+            window = CPU::MEMORY_SIZE;
+        }
+        FuzzInput input, other;
+        while (next_execution++ < config.executions) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                input = corpus[random.below(corpus.size())];
+                other = corpus[random.below(corpus.size())];
+            }
+            mutate(input, other, window, random);
+            bool faulted = execute(input, &trace[0]);
+            consider(input, &trace[0], faulted, &local_virgin[0]);
+        }
+    }
+
+    FuzzStats run(const std::vector<FuzzInput> &seeds) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> trace(CPU::COVERAGE_SIZE);
+        std::vector<uint8_t> local_virgin(virgin);
+        for (size_t i = 0; i < seeds.size(); i++) {
+            add_seed(seeds[i], &trace[0], &local_virgin[0]);
+        }
+        if (corpus.empty()) {
+            add_seed(FuzzInput(), &trace[0], &local_virgin[0]);
+        }
+
+        int threads = config.threads > 0 ? config.threads : (int)std::thread::hardware_concurrency();
+        if (threads < 1) {
+            threads = 1;
+        }
+        std::vector<std::thread> workers;
+        for (int id = 0; id < threads; id++) {
+            workers.push_back(std::thread(&FuzzSession::worker, this, id));
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+
+        FuzzStats stats;
+        stats.executions = config.executions;
+        stats.corpus = corpus.size();
+        stats.edges = 0;
+        for (int i = 0; i < CPU::COVERAGE_SIZE; i++) {
+            stats.edges += virgin[i] != 0xFF;
+        }
+        stats.faulting_inputs = faulting;
+        stats.saved_faults = saved_faults;
+        stats.hangs = hangs;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+};
+
+FuzzStats run_fuzzer(Program &program, const std::vector<FuzzInput> &seeds, const FuzzConfig &config) {
+    init_buckets();
+    if (!config.output_dir.empty()) {
+        mkdir(config.output_dir.c_str(), 0755);
+        mkdir((config.output_dir + "/queue").c_str(), 0755);
+        mkdir((config.output_dir + "/faults").c_str(), 0755);
+    }
+    FuzzSession session(program, config);
+    return session.run(seeds);
+}
+
+void print_fuzz_stats(const FuzzStats &stats, std::ostream &out) {
+    out << "fuzz.executions " << stats.executions << std::endl;
+    out << "fuzz.executions_per_second " << (stats.seconds > 0 ? stats.executions / stats.seconds : 0) << std::endl;
+    out << "fuzz.corpus " << stats.corpus << std::endl;
+    out << "fuzz.edges " << stats.edges << std::endl;
+    out << "fuzz.faulting_inputs " << stats.faulting_inputs << std::endl;
+    out << "fuzz.saved_faults " << stats.saved_faults << std::endl;
+    out << "fuzz.hangs " << stats.hangs << std::endl;
+}
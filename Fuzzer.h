@@ -0,0 +1,56 @@
+// file: Fuzzer.h
+
+#ifndef FUZZER_H
+#define FUZZER_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CPU.h"
+#include "Program.h"
+
+// initial machine state mutated by the fuzzer
+struct FuzzInput {
+    int32_t regs[32];
+    std::vector<uint8_t> memory;    // CPU::MEMORY_SIZE bytes
+
+    FuzzInput();
+    // "xN=value bADDR=value" tokens for the nonzero state, as read by --wide
+    std::string to_string() const;
+};
+
+// parses a --wide style state line; false on a malformed token
+bool parse_fuzz_input(const std::string &line, FuzzInput &input);
+
+struct FuzzConfig {
+    int threads;                // 0 = all hardware threads
+    uint64_t executions;        // total runs over all workers
+    uint64_t max_instructions;  // per run, longer runs count as hangs
+    uint64_t seed;
+    int memory_window;          // mutations touch data memory [0, memory_window)
+    std::string output_dir;     // queue/ and faults/ are written here if set
+
+    FuzzConfig() : threads(0), executions(100000), max_instructions(10000), seed(1),
+                   memory_window(CPU::MEMORY_SIZE) {}
+};
+
+struct FuzzStats {
+    uint64_t executions;
+    uint64_t corpus;            // inputs kept for new coverage
+    uint64_t edges;             // distinct edge map entries seen
+    uint64_t faulting_inputs;   // runs with a memory fault
+    uint64_t saved_faults;      // of those, with coverage not seen faulting before
+    uint64_t hangs;
+    double seconds;
+};
+
+// Coverage-guided fuzzing of the initial registers and data memory. Every
+// worker mutates inputs drawn from a shared corpus, runs them on the
+// reference CPU with edge coverage attached and adds inputs that reach a
+// new edge or a new hit-count bucket (AFL classification) to the corpus.
+FuzzStats run_fuzzer(Program &program, const std::vector<FuzzInput> &seeds, const FuzzConfig &config);
+
+void print_fuzz_stats(const FuzzStats &stats, std::ostream &out);
+
+#endif
@@ -0,0 +1,312 @@
+// file: HostCounters.cpp
+
+#include "HostCounters.h"
+#include "CPU.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sstream>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const char *const EVENT_NAMES[HOST_EVENTS] = {
+    "ns", "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"
+};
+
+static const char *const PHASE_NAMES[HOST_PHASES] = { "fetch", "decode", "execute", "memory" };
+
+// task-clock samples the phase run collects before it stops repeating the program
+static const uint64_t MIN_PHASE_SAMPLES = 1000;
+
+static int open_event(uint32_t type, uint64_t config, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+static uint64_t cache_event(uint64_t cache) {
+    return cache | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+}
+
+HostCounterGroup::HostCounterGroup() {
+    fds[HOST_TASK_CLOCK] = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1);
+    int leader = fds[HOST_TASK_CLOCK];
+    if (leader < 0) {
+        for (int e = 1; e < HOST_EVENTS; e++) {
+            fds[e] = -1;
+        }
+        return;
+    }
+    fds[HOST_CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, leader);
+    fds[HOST_INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, leader);
+    fds[HOST_BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, leader);
+    fds[HOST_L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D), leader);
+    fds[HOST_LLC_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL), leader);
+}
+
+HostCounterGroup::~HostCounterGroup() {
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            close(fds[e]);
+        }
+    }
+}
+
+void HostCounterGroup::enable() {
+    if (is_open()) {
+        ioctl(fds[HOST_TASK_CLOCK], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void HostCounterGroup::disable() {
+    if (is_open()) {
+        ioctl(fds[HOST_TASK_CLOCK], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void HostCounterGroup::read(uint64_t values[HOST_EVENTS]) const {
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        uint64_t data[3] = { 0, 0, 0 };    // value, time enabled, time running
+        values[e] = 0;
+        if (fds[e] < 0 || ::read(fds[e], data, sizeof(data)) != (ssize_t)sizeof(data)) {
+            continue;
+        }
+        values[e] = data[0];
+        if (data[2] && data[2] < data[1]) {
+            values[e] = (uint64_t)((double)data[0] * data[1] / data[2]);
+        }
+    }
+}
+
+// sampling periods: task-clock in nanoseconds, the others in events
+static const uint64_t SAMPLE_PERIODS[HOST_EVENTS] = { 250000, 200003, 200003, 2003, 2003, 211 };
+
+static HostPhases *volatile sampling = NULL;
+
+static void on_sample(int, siginfo_t *info, void *) {
+    if (sampling) {
+        sampling->record_sample(info->si_fd);
+    }
+}
+
+static int open_sampling_event(int event) {
+    static const uint32_t TYPES[HOST_EVENTS] = {
+        PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+    };
+    const uint64_t configs[HOST_EVENTS] = {
+        PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES, cache_event(PERF_COUNT_HW_CACHE_L1D), cache_event(PERF_COUNT_HW_CACHE_LL)
+    };
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = TYPES[event];
+    attr.config = configs[event];
+    attr.sample_period = SAMPLE_PERIODS[event];
+    attr.wakeup_events = 1;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    // every overflow raises the signal on this thread, with si_fd telling the events apart
+    struct f_owner_ex owner;
+    owner.type = F_OWNER_TID;
+    owner.pid = (pid_t)syscall(SYS_gettid);
+    if (fcntl(fd, F_SETFL, O_ASYNC) != 0 || fcntl(fd, F_SETSIG, SIGRTMIN) != 0 ||
+        fcntl(fd, F_SETOWN_EX, &owner) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+HostPhases::HostPhases() : current(HOST_OUTSIDE) {
+    memset(samples, 0, sizeof(samples));
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        fds[e] = -1;
+    }
+}
+
+HostPhases::~HostPhases() {
+    stop();
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            close(fds[e]);
+        }
+    }
+}
+
+bool HostPhases::start() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = on_sample;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGRTMIN, &action, NULL);
+    sampling = this;
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        fds[e] = open_sampling_event(e);
+    }
+    if (fds[HOST_TASK_CLOCK] < 0) {
+        return false;
+    }
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    return true;
+}
+
+void HostPhases::stop() {
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    if (sampling == this) {
+        sampling = NULL;
+    }
+}
+
+void HostPhases::record_sample(int fd) {
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        if (fds[e] == fd) {
+            samples[current][e]++;
+        }
+    }
+}
+
+void enter_host_phase(HostPhases &phases, int phase) {
+    phases.enter(phase);
+}
+
+uint64_t HostPhases::samples_taken(int event) const {
+    uint64_t total = 0;
+    for (int p = 0; p <= HOST_PHASES; p++) {
+        total += samples[p][event];
+    }
+    return total;
+}
+
+void HostPhases::read(int phase, uint64_t values[HOST_EVENTS]) const {
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        values[e] = samples[phase][e] * SAMPLE_PERIODS[e];
+    }
+}
+
+// one "host.<name> ns=.. cycles=.. ..." line of events per guest instruction
+template <class Counters>
+static void print_line(std::ostream &out, const std::string &name, const Counters &counters,
+                       const uint64_t values[HOST_EVENTS], uint64_t guest_instructions) {
+    char number[32];
+    out << "host." << name;
+    for (int e = 0; e < HOST_EVENTS; e++) {
+        if (counters.has(e)) {
+            snprintf(number, sizeof(number), "%.3f", (double)values[e] / (guest_instructions ? guest_instructions : 1));
+            out << " " << EVENT_NAMES[e] << "=" << number;
+        } else {
+            out << " " << EVENT_NAMES[e] << "=unavailable";
+        }
+    }
+    out << std::endl;
+}
+
+EngineResult run_host_counters(Program &program, const DecodedProgram &decoded, uint64_t max_instructions,
+                       std::ostream &out) {
+    static const char *const ENGINE_NAMES[] = { "reference", "fast" };
+    uint64_t values[HOST_EVENTS], whole[HOST_EVENTS];
+    std::ostringstream sink;
+    EngineResult reference = { 0, 0, 0, false };
+
+    for (size_t i = 0; i < sizeof(ENGINE_NAMES) / sizeof(ENGINE_NAMES[0]); i++) {
+        EngineFunction run = select_engine(ENGINE_NAMES[i], "none");
+        HostCounterGroup group;
+        if (!group.is_open()) {
+            out << "host.unavailable perf_event_open failed" << std::endl;
+            return run(program, decoded, max_instructions, sink, NULL);
+        }
+        group.enable();
+        EngineResult result = run(program, decoded, max_instructions, sink, NULL);
+        group.disable();
+        group.read(values);
+        if (i == 0) {
+            reference = result;
+        }
+        print_line(out, std::string("engine.") + ENGINE_NAMES[i], group, values, result.instructions);
+    }
+
+    // the phases of CPU::step by sampling, repeating the program until the
+    // time split rests on enough samples
+    HostPhases phases;
+    HostCounterGroup phase_run;
+    if (!phases.start()) {
+        out << "host.phase.unavailable sampling failed" << std::endl;
+        return reference;
+    }
+    phase_run.enable();
+    uint64_t instructions = 0;
+    do {
+        CPU cpu;
+        cpu.attach_host_phases(&phases);
+        uint64_t executed = 0;
+        while (!max_instructions || executed < max_instructions) {
+            if (!cpu.step(program.instructions())) {
+                break;
+            }
+            executed++;
+            if (cpu.readPC() > (unsigned long)program.maxPC * 8) {
+                break;
+            }
+        }
+        cpu.attach_host_phases(NULL);
+        instructions += executed;
+        if (executed == 0) {
+            break;
+        }
+    } while (phases.samples_taken(HOST_TASK_CLOCK) < MIN_PHASE_SAMPLES);
+    phase_run.disable();
+    phases.stop();
+    phase_run.read(whole);
+
+    // the phases cannot add up to more than the run they were sampled
+    // from; if they do, the attribution is broken and is not printed
+    uint64_t phase_values[HOST_PHASES][HOST_EVENTS];
+    uint64_t sums[HOST_EVENTS] = { 0 };
+    for (int p = 0; p < HOST_PHASES; p++) {
+        phases.read(p, phase_values[p]);
+        for (int e = 0; e < HOST_EVENTS; e++) {
+            sums[e] += phase_values[p][e];
+        }
+    }
+    static const int CHECKED[] = { HOST_TASK_CLOCK, HOST_INSTRUCTIONS };
+    for (size_t c = 0; c < sizeof(CHECKED) / sizeof(CHECKED[0]); c++) {
+        int e = CHECKED[c];
+        if (phases.has(e) && phase_run.has(e) && sums[e] > whole[e]) {
+            out << "host.phase.invalid " << EVENT_NAMES[e] << " phases " << sums[e] << " whole run " << whole[e]
+                << std::endl;
+            out << "host.guest_instructions " << instructions << std::endl;
+            return reference;
+        }
+    }
+    for (int p = 0; p < HOST_PHASES; p++) {
+        print_line(out, std::string("phase.") + PHASE_NAMES[p], phases, phase_values[p], instructions);
+    }
+    out << "host.guest_instructions " << instructions << std::endl;
+    return reference;
+}
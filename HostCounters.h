@@ -0,0 +1,87 @@
+// file: HostCounters.h
+
+#ifndef HOST_COUNTERS_H
+#define HOST_COUNTERS_H
+
+#include <cstdint>
+#include <ostream>
+#include "Engines.h"
+#include "HostPhases.h"
+#include "Predecode.h"
+#include "Program.h"
+
+// Linux perf_event_open counters of the simulator process itself, user
+// mode only. Events the host or container does not expose (hardware
+// counters in most VMs) are reported as unavailable; task-clock is a
+// software event and always works.
+
+enum HostEvent {
+    HOST_TASK_CLOCK,        // nanoseconds on the CPU
+    HOST_CYCLES,
+    HOST_INSTRUCTIONS,
+    HOST_BRANCH_MISSES,
+    HOST_L1D_MISSES,        // L1 data read misses
+    HOST_LLC_MISSES,        // last-level cache read misses
+    HOST_EVENTS
+};
+
+// One perf event group: task-clock leads and the hardware events follow
+// it, so the whole group is enabled and disabled with one ioctl.
+class HostCounterGroup {
+private:
+    int fds[HOST_EVENTS];
+
+    HostCounterGroup(const HostCounterGroup &);
+    HostCounterGroup &operator=(const HostCounterGroup &);
+
+public:
+    HostCounterGroup();
+    ~HostCounterGroup();
+
+    bool is_open() const { return fds[HOST_TASK_CLOCK] >= 0; }
+    bool has(int event) const { return fds[event] >= 0; }
+    void enable();
+    void disable();
+    // totals so far, scaled up when the kernel multiplexed the counters
+    void read(uint64_t values[HOST_EVENTS]) const;
+};
+
+// Per-phase attribution of CPU::step by sampling, attached with
+// CPU::attach_host_phases. Switching phases only stores the phase number;
+// every host event overflows into a signal after a fixed period, and the
+// handler charges one period to the phase that was current. Nothing is
+// read at the switches, so they add no system calls and no counts.
+class HostPhases {
+private:
+    int fds[HOST_EVENTS];               // one sampling event each, -1 if unavailable
+    uint64_t samples[HOST_PHASES + 1][HOST_EVENTS];     // the last row is HOST_OUTSIDE
+    volatile int current;
+
+    HostPhases(const HostPhases &);
+    HostPhases &operator=(const HostPhases &);
+
+public:
+    HostPhases();
+    ~HostPhases();
+
+    void enter(int phase) { current = phase; }
+    // starts and stops sampling on the calling thread; one instance at a time
+    bool start();
+    void stop();
+    // called from the signal handler
+    void record_sample(int fd);
+
+    bool has(int event) const { return fds[event] >= 0; }
+    uint64_t samples_taken(int event) const;
+    // sampled totals of a phase: samples times the period
+    void read(int phase, uint64_t values[HOST_EVENTS]) const;
+};
+
+// Runs the program on every engine with a counter group around each run,
+// then once more on the reference CPU with per-phase groups, and prints
+// host events per guest instruction ("host.*" lines). Returns the result
+// of the reference run.
+EngineResult run_host_counters(Program &program, const DecodedProgram &decoded, uint64_t max_instructions,
+                       std::ostream &out);
+
+#endif
@@ -0,0 +1,24 @@
+// file: HostPhases.h
+
+#ifndef HOST_PHASES_H
+#define HOST_PHASES_H
+
+// The part of the host counters CPU::step needs: the phases it reports and
+// a way to switch between them, without the perf and engine headers
+// (HostCounters.h defines HostPhases).
+
+class HostPhases;
+
+enum HostPhase {
+    HOST_FETCH,
+    HOST_DECODE,
+    HOST_EXECUTE,
+    HOST_MEMORY,            // loads, stores and atomics, split out of execute
+    HOST_PHASES,
+    HOST_OUTSIDE = HOST_PHASES
+};
+
+// HostPhases::enter
+void enter_host_phase(HostPhases &phases, int phase);
+
+#endif
@@ -0,0 +1,131 @@
+// file: Instrumentation.h
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include "CPU.h"
+#include "Trace.h"
+
+// Instrumentation policies for the engines' step loops. A policy sees every
+// retired instruction through retire(); `enabled` is a compile-time
+// constant, so with NoInstrumentation the engines do not even build the
+// RetiredInst record and the instantiation is the plain loop. Every policy
+// can be built from the stream it reports to.
+
+struct NoInstrumentation {
+    static const bool enabled = false;
+    NoInstrumentation() {}
+    explicit NoInstrumentation(std::ostream &) {}
+    void retire(const RetiredInst &) {}
+    void report(std::ostream &) const {}
+};
+
+// instruction mix counters
+struct CountingInstrumentation {
+    static const bool enabled = true;
+    uint64_t instructions;
+    uint64_t alu;
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t atomics;
+    uint64_t branches;
+    uint64_t taken_branches;
+    uint64_t jumps;
+
+    CountingInstrumentation()
+        : instructions(0), alu(0), loads(0), stores(0), atomics(0), branches(0), taken_branches(0), jumps(0) {}
+    explicit CountingInstrumentation(std::ostream &)
+        : instructions(0), alu(0), loads(0), stores(0), atomics(0), branches(0), taken_branches(0), jumps(0) {}
+
+    void retire(const RetiredInst &inst) {
+        instructions++;
+        switch (inst.opcode) {
+            case 0x03: loads++; break;
+            case 0x23: stores++; break;
+            case 0x2F: atomics++; break;
+            case 0x63: branches++; taken_branches += inst.taken; break;
+            case 0x6F: jumps++; break;
+            default: alu++; break;
+        }
+    }
+
+    void report(std::ostream &out) const {
+        out << "count.instructions " << instructions << std::endl;
+        out << "count.alu " << alu << std::endl;
+        out << "count.loads " << loads << std::endl;
+        out << "count.stores " << stores << std::endl;
+        out << "count.atomics " << atomics << std::endl;
+        out << "count.branches " << branches << std::endl;
+        out << "count.taken_branches " << taken_branches << std::endl;
+        out << "count.jumps " << jumps << std::endl;
+    }
+};
+
+// one text line per retired instruction, the live version of the
+// commented-out debug output in CPU::execute
+struct TraceInstrumentation {
+    static const bool enabled = true;
+    std::ostream *out;
+
+    explicit TraceInstrumentation(std::ostream &stream) : out(&stream) {}
+
+    void retire(const RetiredInst &inst) {
+        char line[96];
+        int length = snprintf(line, sizeof(line), "pc 0x%04x inst 0x%08x", inst.pc, inst.inst);
+        if (inst.regWrite) {
+            length += snprintf(line + length, sizeof(line) - length, " x%u=%d", inst.rd, inst.result);
+        }
+        if (inst.memRe || inst.memWr) {
+            const char *kind = inst.memRe && inst.memWr ? "amo" : inst.memRe ? "load" : "store";
+            length += snprintf(line + length, sizeof(line) - length, " %s 0x%x = %d", kind, inst.mem_address,
+                               inst.mem_value);
+        }
+        if (inst.taken) {
+            length += snprintf(line + length, sizeof(line) - length, " taken");
+        }
+        line[length++] = '\n';
+        out->write(line, length);
+    }
+
+    void report(std::ostream &) const {}
+};
+
+// compact binary trace (see Trace.h) written by a background thread
+struct BinaryTraceInstrumentation {
+    static const bool enabled = true;
+    TraceWriter writer;
+
+    explicit BinaryTraceInstrumentation(std::ostream &stream) : writer(stream) {}
+
+    void retire(const RetiredInst &inst) {
+        TraceRecord record;
+        record.pc = inst.pc;
+        record.word = inst.inst;
+        record.flags = 0;
+        record.rd = inst.rd;
+        record.value = inst.result;
+        record.mem_address = inst.mem_address;
+        record.mem_value = inst.mem_value;
+        if (inst.regWrite && inst.rd != 0) {
+            record.flags |= TRACE_REG;
+        }
+        if (inst.memRe) {
+            record.flags |= TRACE_LOAD;
+        }
+        if (inst.memWr) {
+            record.flags |= TRACE_STORE;
+        }
+        if (inst.taken) {
+            record.flags |= TRACE_TAKEN;
+        }
+        writer.append(record);
+    }
+
+    // the stream is the trace file, so this only finishes it
+    void report(std::ostream &) { writer.close(); }
+};
+
+#endif
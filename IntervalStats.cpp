@@ -0,0 +1,151 @@
+// file: IntervalStats.cpp
+
+#include "IntervalStats.h"
+#include "Varint.h"
+
+#include <fstream>
+
+static const uint32_t INTERVAL_STATS_VERSION = 1;
+static const size_t ROWS_PER_BLOCK = 4096;
+
+const char *const STAT_NAMES[STAT_COUNTERS] = {
+    "instructions", "alu", "loads", "stores", "atomics", "branches", "taken_branches", "jumps",
+    "cycles", "dcache_hits", "dcache_misses", "bpred_lookups", "bpred_mispredicts"
+};
+
+static void write_u32(std::ostream &out, uint32_t value) {
+    char bytes[4] = { (char)(value & 0xFF), (char)(value >> 8 & 0xFF), (char)(value >> 16 & 0xFF),
+                      (char)(value >> 24) };
+    out.write(bytes, 4);
+}
+
+static bool read_u32(std::istream &in, uint32_t &value) {
+    unsigned char bytes[4];
+    if (!in.read((char *)bytes, 4)) {
+        return false;
+    }
+    value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    return true;
+}
+
+IntervalStatsWriter::IntervalStatsWriter(std::ostream &stream, const char *const *names, int count)
+    : out(stream), columns(count), rows(0) {
+    out.write("CPUSIMIS", 8);
+    write_u32(out, INTERVAL_STATS_VERSION);
+    write_u32(out, count);
+    for (int c = 0; c < count; c++) {
+        out.write(names[c], strlen(names[c]) + 1);
+        columns[c].reserve(ROWS_PER_BLOCK);
+    }
+}
+
+IntervalStatsWriter::~IntervalStatsWriter() {
+    close();
+}
+
+void IntervalStatsWriter::append(const uint64_t *row) {
+    for (size_t c = 0; c < columns.size(); c++) {
+        columns[c].push_back(row[c]);
+    }
+    if (++rows == ROWS_PER_BLOCK) {
+        flush_block();
+    }
+}
+
+void IntervalStatsWriter::flush_block() {
+    if (rows == 0) {
+        return;
+    }
+    std::vector<uint8_t> payload;
+    for (size_t c = 0; c < columns.size(); c++) {
+        uint64_t previous = 0;
+        for (size_t r = 0; r < rows; r++) {
+            put_varint(payload, zigzag((int64_t)(columns[c][r] - previous)));
+            previous = columns[c][r];
+        }
+        columns[c].clear();
+    }
+    write_u32(out, rows);
+    write_u32(out, payload.size());
+    out.write((const char *)&payload[0], payload.size());
+    rows = 0;
+}
+
+void IntervalStatsWriter::close() {
+    flush_block();
+    out.flush();
+}
+
+bool read_interval_stats(const std::string &path, std::vector<std::string> &names,
+                         std::vector<std::vector<uint64_t> > &columns) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[8];
+    uint32_t version, count;
+    if (!in.read(magic, 8) || memcmp(magic, "CPUSIMIS", 8) != 0 || !read_u32(in, version) ||
+        version != INTERVAL_STATS_VERSION || !read_u32(in, count)) {
+        return false;
+    }
+    names.assign(count, std::string());
+    columns.assign(count, std::vector<uint64_t>());
+    for (uint32_t c = 0; c < count; c++) {
+        if (!std::getline(in, names[c], '\0')) {
+            return false;
+        }
+    }
+    uint32_t rows, bytes;
+    while (read_u32(in, rows) && read_u32(in, bytes)) {
+        std::vector<uint8_t> payload(bytes);
+        if (bytes && !in.read((char *)&payload[0], bytes)) {
+            return false;
+        }
+        const uint8_t *cursor = payload.empty() ? NULL : &payload[0];
+        const uint8_t *end = cursor + bytes;
+        for (uint32_t c = 0; c < count; c++) {
+            uint64_t value = 0, delta;
+            for (uint32_t r = 0; r < rows; r++) {
+                if (!get_varint(cursor, end, delta)) {
+                    return false;
+                }
+                value += (uint64_t)unzigzag(delta);
+                columns[c].push_back(value);
+            }
+        }
+    }
+    return true;
+}
+
+IntervalStats::IntervalStats(std::ostream &out, uint64_t length, OOOCore *model)
+    : writer(out, STAT_NAMES, STAT_COUNTERS), core(model), interval(length ? length : 1), left(interval) {
+    read_model(model_base);
+}
+
+// the timing model's cumulative counters, in their StatCounter slots
+void IntervalStats::read_model(uint64_t values[STAT_COUNTERS]) const {
+    memset(values, 0, sizeof(uint64_t) * STAT_COUNTERS);
+    if (core) {
+        values[STAT_CYCLES] = core->get_cycles();
+        values[STAT_DCACHE_HITS] = core->get_dcache().hits;
+        values[STAT_DCACHE_MISSES] = core->get_dcache().misses;
+        values[STAT_BPRED_LOOKUPS] = core->get_predictor().lookups;
+        values[STAT_BPRED_MISPREDICTS] = core->get_predictor().mispredicts;
+    }
+}
+
+void IntervalStats::close_interval() {
+    uint64_t model[STAT_COUNTERS];
+    read_model(model);
+    for (int c = STAT_CYCLES; c < STAT_COUNTERS; c++) {
+        counters[c] = model[c] - model_base[c];
+        model_base[c] = model[c];
+    }
+    writer.append(counters.values);
+    counters.reset();
+    left = interval;
+}
+
+void IntervalStats::finish() {
+    if (counters[STAT_INSTRUCTIONS]) {
+        close_interval();
+    }
+    writer.close();
+}
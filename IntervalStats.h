@@ -0,0 +1,112 @@
+// file: IntervalStats.h
+
+#ifndef INTERVAL_STATS_H
+#define INTERVAL_STATS_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CPU.h"
+#include "OOOCore.h"
+
+// Aggregated counters: every statistic is a slot of one flat array that
+// the run loop bumps as events happen, so closing an interval is a copy
+// and a memset rather than a walk over the models.
+enum StatCounter {
+    STAT_INSTRUCTIONS,
+    STAT_ALU,
+    STAT_LOADS,
+    STAT_STORES,
+    STAT_ATOMICS,
+    STAT_BRANCHES,
+    STAT_TAKEN_BRANCHES,
+    STAT_JUMPS,
+    STAT_CYCLES,            // the timing model's counters, 0 without one
+    STAT_DCACHE_HITS,
+    STAT_DCACHE_MISSES,
+    STAT_BPRED_LOOKUPS,
+    STAT_BPRED_MISPREDICTS,
+    STAT_COUNTERS
+};
+
+extern const char *const STAT_NAMES[STAT_COUNTERS];
+
+struct StatCounters {
+    uint64_t values[STAT_COUNTERS];
+
+    StatCounters() { reset(); }
+    void reset() { memset(values, 0, sizeof(values)); }
+    uint64_t &operator[](int counter) { return values[counter]; }
+    uint64_t operator[](int counter) const { return values[counter]; }
+};
+
+// Columnar time series file:
+//
+//   header  "CPUSIMIS", u32 version, u32 columns, column names (NUL terminated)
+//   block   u32 rows, u32 payload bytes, payload
+//
+// The payload holds each column in turn, one zigzag varint per row with
+// the difference to the previous row of the block, so steady phases take
+// about a byte per value. Blocks decode independently.
+class IntervalStatsWriter {
+private:
+    std::ostream &out;
+    std::vector<std::vector<uint64_t> > columns;
+    size_t rows;
+
+    void flush_block();
+
+public:
+    IntervalStatsWriter(std::ostream &out, const char *const *names, int count);
+    ~IntervalStatsWriter();
+
+    void append(const uint64_t *row);
+    void close();
+};
+
+// reads a whole file into one vector per column; false if it is not one
+bool read_interval_stats(const std::string &path, std::vector<std::string> &names,
+                         std::vector<std::vector<uint64_t> > &columns);
+
+// Counts retired instructions into StatCounters and writes one row every
+// `interval` instructions. The timing model's cumulative counters are
+// turned into per-interval values by subtracting their value at the
+// previous boundary.
+class IntervalStats {
+private:
+    StatCounters counters;
+    uint64_t model_base[STAT_COUNTERS];
+    IntervalStatsWriter writer;
+    OOOCore *core;
+    uint64_t interval;
+    uint64_t left;          // instructions until the boundary
+
+    void read_model(uint64_t values[STAT_COUNTERS]) const;
+    void close_interval();
+
+public:
+    // core may be NULL; interval must be at least 1
+    IntervalStats(std::ostream &out, uint64_t interval, OOOCore *core);
+
+    void retire(const RetiredInst &inst) {
+        counters[STAT_INSTRUCTIONS]++;
+        switch (inst.opcode) {
+            case 0x03: counters[STAT_LOADS]++; break;
+            case 0x23: counters[STAT_STORES]++; break;
+            case 0x2F: counters[STAT_ATOMICS]++; break;
+            case 0x63: counters[STAT_BRANCHES]++; counters[STAT_TAKEN_BRANCHES] += inst.taken; break;
+            case 0x6F: counters[STAT_JUMPS]++; break;
+            default: counters[STAT_ALU]++; break;
+        }
+        if (--left == 0) {
+            close_interval();
+        }
+    }
+
+    // writes the last partial interval and finishes the file
+    void finish();
+};
+
+#endif
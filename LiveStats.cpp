@@ -0,0 +1,74 @@
+// file: LiveStats.cpp
+
+#include "LiveStats.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+LiveStats::~LiveStats() {
+    if (page) {
+        munmap(page, sizeof(LiveStatsPage));
+    }
+}
+
+bool LiveStats::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(LiveStatsPage)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *mapped = mmap(NULL, sizeof(LiveStatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    // the file is zero-filled, which is a valid initial state for the atomics
+    page = (LiveStatsPage *)mapped;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    page->version = LIVE_STATS_VERSION;
+    page->pid = getpid();
+    page->start_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    page->state.store(LIVE_RUNNING, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(page->magic, "CPUSIMLS", 8);
+    return true;
+}
+
+void LiveStats::finish(uint64_t instructions, OOOCore *core) {
+    publish(instructions, core);
+    page->state.store(LIVE_FINISHED, std::memory_order_release);
+}
+
+const LiveStatsPage *map_live_stats(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(LiveStatsPage)) {
+        mapped = mmap(NULL, sizeof(LiveStatsPage), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return NULL;
+    }
+    const LiveStatsPage *page = (const LiveStatsPage *)mapped;
+    if (memcmp(page->magic, "CPUSIMLS", 8) != 0 || page->version != LIVE_STATS_VERSION) {
+        munmap(mapped, sizeof(LiveStatsPage));
+        return NULL;
+    }
+    return page;
+}
+
+void unmap_live_stats(const LiveStatsPage *page) {
+    munmap((void *)page, sizeof(LiveStatsPage));
+}
@@ -0,0 +1,73 @@
+// file: LiveStats.h
+
+#ifndef LIVE_STATS_H
+#define LIVE_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "OOOCore.h"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "live statistics need lock-free 64-bit atomics");
+
+static const uint32_t LIVE_STATS_VERSION = 1;
+
+enum LiveState {
+    LIVE_STARTING,
+    LIVE_RUNNING,
+    LIVE_FINISHED
+};
+
+// Layout of the shared file. The simulator stores with relaxed atomics
+// and never waits on a reader; a monitor maps the file read-only and
+// computes rates from its own clock.
+struct LiveStatsPage {
+    char magic[8];                      // "CPUSIMLS"
+    uint32_t version;
+    uint32_t pid;                       // of the simulator
+    uint64_t start_ns;                  // CLOCK_MONOTONIC at open
+    std::atomic<uint32_t> state;
+    std::atomic<uint64_t> instructions;
+    std::atomic<uint64_t> cycles;       // 0 without a timing model
+    std::atomic<uint64_t> dcache_hits;
+    std::atomic<uint64_t> dcache_misses;
+    std::atomic<uint64_t> bpred_lookups;
+    std::atomic<uint64_t> bpred_mispredicts;
+};
+
+// Publisher side, used by the simulator's run loops at basic block
+// boundaries.
+class LiveStats {
+private:
+    LiveStatsPage *page;
+
+    LiveStats(const LiveStats &);
+    LiveStats &operator=(const LiveStats &);
+
+public:
+    LiveStats() : page(NULL) {}
+    ~LiveStats();
+
+    // creates or replaces the file; false if it cannot be mapped
+    bool open(const std::string &path);
+
+    // core may be NULL when there is no timing model
+    void publish(uint64_t instructions, OOOCore *core) {
+        page->instructions.store(instructions, std::memory_order_relaxed);
+        if (core) {
+            page->cycles.store(core->get_cycles(), std::memory_order_relaxed);
+            page->dcache_hits.store(core->get_dcache().hits, std::memory_order_relaxed);
+            page->dcache_misses.store(core->get_dcache().misses, std::memory_order_relaxed);
+            page->bpred_lookups.store(core->get_predictor().lookups, std::memory_order_relaxed);
+            page->bpred_mispredicts.store(core->get_predictor().mispredicts, std::memory_order_relaxed);
+        }
+    }
+    void finish(uint64_t instructions, OOOCore *core);
+};
+
+// Reader side: maps a live statistics file read-only, NULL if it is not one.
+// Release with unmap_live_stats.
+const LiveStatsPage *map_live_stats(const std::string &path);
+void unmap_live_stats(const LiveStatsPage *page);
+
+#endif
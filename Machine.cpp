@@ -0,0 +1,141 @@
+// file: Machine.cpp
+
+#include "Machine.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+Machine::Machine() : status(NOT_LOADED) {
+    reset();
+    status = NOT_LOADED;
+}
+
+Machine::Machine(const Machine &other)
+    : program(other.program), cpu(new CPU(*other.cpu)), status(other.status), stats(other.stats) {}
+
+Machine &Machine::operator=(const Machine &other) {
+    if (this != &other) {
+        program = other.program;
+        cpu.reset(new CPU(*other.cpu));
+        status = other.status;
+        stats = other.stats;
+    }
+    return *this;
+}
+
+Machine::~Machine() {}
+
+bool Machine::load_file(const std::string &path) {
+    if (!load_program(path.c_str(), program)) {
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void Machine::load_text(const char *text, size_t length) {
+    std::istringstream in(std::string(text, length));
+    load_program(in, program);
+    reset();
+}
+
+void Machine::load_binary(const uint8_t *bytes, size_t length) {
+    std::string text;
+    char hex[4];
+    for (size_t i = 0; i < length; i++) {
+        snprintf(hex, sizeof(hex), "%02x\n", bytes[i]);
+        text += hex;
+    }
+    load_text(text.data(), text.size());
+}
+
+void Machine::reset() {
+    cpu.reset(new CPU());
+    cpu->set_report_faults(false);
+    memset(&stats, 0, sizeof(stats));
+    status = program.image.empty() ? NOT_LOADED : RUNNING;
+}
+
+bool Machine::step() {
+    if (status == NOT_LOADED || status == FINISHED) {
+        return false;
+    }
+    if (cpu->readPC() > (unsigned long)program.maxPC * 8) {
+        status = FINISHED;
+        return false;
+    }
+    RetiredInst retired;
+    uint64_t faults = cpu->get_faults();
+    bool running = cpu->step(program.instructions(), &retired);
+    stats.faults += cpu->get_faults() - faults;
+    if (!running) {
+        status = FINISHED;
+        return false;
+    }
+    stats.instructions++;
+    stats.loads += retired.memRe && !retired.memWr;
+    stats.stores += retired.memWr && !retired.memRe;
+    stats.atomics += retired.opcode == 0x2F;
+    stats.branches += retired.opcode == 0x63;
+    stats.taken_branches += retired.opcode == 0x63 && retired.taken;
+    stats.jumps += retired.opcode == 0x6F;
+    if (cpu->readPC() > (unsigned long)program.maxPC * 8) {
+        status = FINISHED;
+    } else {
+        status = RUNNING;
+    }
+    return true;
+}
+
+Machine::Status Machine::run(uint64_t max_instructions) {
+    uint64_t executed = 0;
+    while (status == RUNNING || status == LIMIT) {
+        if (max_instructions && executed >= max_instructions) {
+            status = LIMIT;
+            break;
+        }
+        if (!step()) {
+            break;
+        }
+        executed++;
+    }
+    return status;
+}
+
+int32_t Machine::get_register(int reg) const {
+    return reg >= 0 && reg < 32 ? cpu->get_register_value(reg) : 0;
+}
+
+void Machine::set_register(int reg, int32_t value) {
+    if (reg >= 0 && reg < 32) {
+        cpu->set_register_value(reg, value);
+    }
+}
+
+uint32_t Machine::get_pc() const {
+    return cpu->readPC() / 2;
+}
+
+void Machine::set_pc(uint32_t pc) {
+    cpu->setPC((unsigned long)pc * 2);
+    if (status == FINISHED || status == LIMIT) {
+        status = RUNNING;
+    }
+}
+
+uint8_t Machine::read_byte(uint32_t address) const {
+    return address < (uint32_t)MEMORY_SIZE ? (uint8_t)cpu->read_memory(address, true) : 0;
+}
+
+void Machine::write_byte(uint32_t address, uint8_t value) {
+    cpu->write_memory(address, value, true);
+}
+
+int32_t Machine::read_word(uint32_t address) const {
+    return cpu->read_memory(address, false);
+}
+
+void Machine::write_word(uint32_t address, int32_t value) {
+    cpu->write_memory(address, value, false);
+}
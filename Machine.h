@@ -0,0 +1,83 @@
+// file: Machine.h
+
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "CPU.h"
+#include "Program.h"
+
+struct MachineStats {
+    uint64_t instructions;
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t branches;
+    uint64_t taken_branches;
+    uint64_t jumps;
+    uint64_t atomics;
+    uint64_t faults;        // out-of-bounds or unaligned accesses
+};
+
+// Embedding API of libcpusim: one simulated machine (program image, CPU
+// state and counters) that a host program drives in-process. Machines are
+// independent, so a harness may run many of them on its own threads.
+// Copying a machine snapshots its whole state; moving one (as a vector of
+// machines does when it grows) transfers it, and the moved-from machine
+// must be reset() or assigned before it is used again.
+class Machine {
+public:
+    enum Status {
+        NOT_LOADED,     // no program yet
+        RUNNING,        // can still execute
+        FINISHED,       // reached the NULL instruction or ran past the image
+        LIMIT           // the last run() stopped at max_instructions
+    };
+
+private:
+    Program program;
+    std::unique_ptr<CPU> cpu;
+    Status status;
+    MachineStats stats;
+
+public:
+    Machine();
+    Machine(const Machine &other);
+    Machine &operator=(const Machine &other);
+    Machine(Machine &&other) = default;
+    Machine &operator=(Machine &&other) = default;
+    ~Machine();
+
+    // the text format of cpusim: one hex byte per line
+    bool load_file(const std::string &path);
+    void load_text(const char *text, size_t length);
+    // raw instruction bytes, little endian as in memory
+    void load_binary(const uint8_t *bytes, size_t length);
+
+    // back to PC 0 with zeroed registers, memory and stats; keeps the program
+    void reset();
+
+    // executes one instruction; false once the program has finished
+    bool step();
+    // runs until the program finishes or max_instructions more have executed (0 = no limit)
+    Status run(uint64_t max_instructions);
+    Status get_status() const { return status; }
+
+    int32_t get_register(int reg) const;
+    void set_register(int reg, int32_t value);   // writes to x0 are ignored
+    uint32_t get_pc() const;                     // byte address
+    void set_pc(uint32_t pc);
+
+    // data memory, MEMORY_SIZE bytes; accesses outside it read 0 and are dropped
+    static const int MEMORY_SIZE = CPU::MEMORY_SIZE;
+    uint8_t read_byte(uint32_t address) const;
+    void write_byte(uint32_t address, uint8_t value);
+    int32_t read_word(uint32_t address) const;   // address must be 4-byte aligned
+    void write_word(uint32_t address, int32_t value);
+
+    const MachineStats &get_stats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,248 @@
+// file: MultiHart.cpp
+
+#include "MultiHart.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static const uint64_t FINISHED = ~0ULL;
+
+MultiHartSystem::MultiHartSystem(Program &prog, int num_harts)
+    : program(prog), memory(CPU::MEMORY_SIZE), all_finished(false), instruction_limit(0),
+      coherence(NULL), quanta(0) {
+    if (num_harts < 1) {
+        num_harts = 1;
+    }
+    progress = new std::atomic<uint64_t>[num_harts];
+    for (int id = 0; id < num_harts; id++) {
+        CPU *cpu = new CPU();
+        cpu->attach_memory(&memory);
+        cpu->set_register_value(10, id); // a0 = hart id
+        harts.push_back(cpu);
+        logs.push_back(new StoreLog(CPU::MEMORY_SIZE));
+        progress[id].store(0);
+    }
+    counts.assign(num_harts, 0);
+    limited.assign(num_harts, 0);
+    finished.assign(num_harts, 0);
+    pending_atomic.assign(num_harts, 0);
+    access_logs.resize(num_harts);
+}
+
+MultiHartSystem::~MultiHartSystem() {
+    for (size_t id = 0; id < harts.size(); id++) {
+        delete harts[id];
+        delete logs[id];
+    }
+    delete[] progress;
+}
+
+uint64_t MultiHartSystem::slowest_active(int self) const {
+    uint64_t slowest = FINISHED;
+    for (int id = 0; id < (int)harts.size(); id++) {
+        uint64_t count = progress[id].load(std::memory_order_acquire);
+        if (id != self && count < slowest) {
+            slowest = count;
+        }
+    }
+    return slowest;
+}
+
+void MultiHartSystem::run_hart(int id, uint64_t quantum, uint64_t max_instructions) {
+    CPU &cpu = *harts[id];
+    uint64_t count = 0;
+    bool done = true;
+    while (done) {
+        if (max_instructions && count >= max_instructions) {
+            limited[id] = 1;
+            break;
+        }
+        done = cpu.step(program.instructions());
+        if (done) {
+            count++;
+        }
+        if (cpu.readPC() > (unsigned long)program.maxPC * 8) {
+            break;
+        }
+        if (quantum && count % quantum == 0) {
+            progress[id].store(count, std::memory_order_release);
+            while (count > quantum) {
+                uint64_t slowest = slowest_active(id);
+                if (slowest == FINISHED || count <= slowest + quantum) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+    counts[id] = count;
+    progress[id].store(FINISHED, std::memory_order_release);
+}
+
+void MultiHartSystem::run_parallel(uint64_t quantum, uint64_t max_instructions) {
+    std::vector<std::thread> threads;
+    for (int id = 0; id < (int)harts.size(); id++) {
+        threads.push_back(std::thread(&MultiHartSystem::run_hart, this, id, quantum, max_instructions));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+// Reusable barrier; the last thread to arrive runs the completion step
+// before anyone is released.
+class QuantumBarrier {
+private:
+    std::mutex lock;
+    std::condition_variable released;
+    int parties;
+    int waiting;
+    uint64_t generation;
+
+public:
+    explicit QuantumBarrier(int count) : parties(count), waiting(0), generation(0) {}
+
+    template <class Completion>
+    void arrive_and_wait(Completion completion) {
+        std::unique_lock<std::mutex> guard(lock);
+        uint64_t arrived_in = generation;
+        if (++waiting == parties) {
+            completion();
+            waiting = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        while (generation == arrived_in) {
+            released.wait(guard);
+        }
+    }
+};
+
+// low 7 bits of the instruction at the hart's PC
+static int next_opcode(Program &program, unsigned long pc) {
+    if (pc + 1 >= program.image.size()) {
+        return 0;
+    }
+    char hex[3] = { program.image[pc], program.image[pc + 1], 0 };
+    return strtol(hex, NULL, 16) & 0x7F;
+}
+
+// one main loop iteration for a hart; false once it has finished
+bool MultiHartSystem::step_hart(int id) {
+    CPU &cpu = *harts[id];
+    if (instruction_limit && counts[id] >= instruction_limit) {
+        limited[id] = 1;
+        finished[id] = 1;
+        return false;
+    }
+    bool done;
+    if (coherence) {
+        RetiredInst retired;
+        done = cpu.step(program.instructions(), &retired);
+        if (done && (retired.memRe || retired.memWr)) {
+            access_logs[id].push_back((uint64_t)retired.mem_address << 1 | (retired.memWr ? 1 : 0));
+        }
+    } else {
+        done = cpu.step(program.instructions());
+    }
+    if (done) {
+        counts[id]++;
+    }
+    if (!done || cpu.readPC() > (unsigned long)program.maxPC * 8) {
+        finished[id] = 1;
+    }
+    return !finished[id];
+}
+
+void MultiHartSystem::run_quanta(int id, uint64_t quantum, QuantumBarrier &barrier) {
+    CPU &cpu = *harts[id];
+    while (!all_finished) {
+        for (uint64_t executed = 0; executed < quantum && !finished[id]; executed++) {
+            if (next_opcode(program, cpu.readPC()) == 0x2F) {
+                pending_atomic[id] = 1;
+                break;
+            }
+            step_hart(id);
+        }
+        barrier.arrive_and_wait([this]() { end_quantum(); });
+    }
+}
+
+// feeds the recorded accesses to the coherence model, one per hart in turn
+void MultiHartSystem::replay_accesses() {
+    if (!coherence) {
+        return;
+    }
+    size_t longest = 0;
+    for (size_t id = 0; id < harts.size(); id++) {
+        longest = std::max(longest, access_logs[id].size());
+    }
+    for (size_t i = 0; i < longest; i++) {
+        for (size_t id = 0; id < harts.size(); id++) {
+            if (i < access_logs[id].size()) {
+                uint64_t entry = access_logs[id][i];
+                coherence->access(id, (uint32_t)(entry >> 1), entry & 1);
+            }
+        }
+    }
+    for (size_t id = 0; id < harts.size(); id++) {
+        access_logs[id].clear();
+    }
+}
+
+// runs on the last hart to reach the barrier while the others wait
+void MultiHartSystem::end_quantum() {
+    for (size_t id = 0; id < harts.size(); id++) {
+        logs[id]->commit(memory);
+    }
+    replay_accesses();
+    for (size_t id = 0; id < harts.size(); id++) {
+        if (pending_atomic[id] && !finished[id]) {
+            harts[id]->attach_store_log(NULL);
+            step_hart(id);
+            harts[id]->attach_store_log(logs[id]);
+        }
+        pending_atomic[id] = 0;
+    }
+    replay_accesses();
+    quanta++;
+    all_finished = true;
+    for (size_t id = 0; id < harts.size(); id++) {
+        all_finished = all_finished && finished[id];
+    }
+}
+
+void MultiHartSystem::run_deterministic(uint64_t quantum, uint64_t max) {
+    if (quantum == 0) {
+        quantum = 1;
+    }
+    instruction_limit = max;
+    for (size_t id = 0; id < harts.size(); id++) {
+        harts[id]->attach_store_log(logs[id]);
+    }
+    QuantumBarrier barrier(harts.size());
+    std::vector<std::thread> threads;
+    for (int id = 0; id < (int)harts.size(); id++) {
+        threads.push_back(std::thread(&MultiHartSystem::run_quanta, this, id, quantum, std::ref(barrier)));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    for (size_t id = 0; id < harts.size(); id++) {
+        harts[id]->attach_store_log(NULL);
+    }
+}
+
+void MultiHartSystem::print_results(std::ostream &out) const {
+    for (size_t id = 0; id < harts.size(); id++) {
+        out << "hart " << id << " (" << harts[id]->get_register_value(10) << ","
+            << harts[id]->get_register_value(11) << ") instructions " << counts[id]
+            << (limited[id] ? " limit" : "") << std::endl;
+    }
+    if (quanta) {
+        out << "quanta " << quanta << std::endl;
+    }
+}
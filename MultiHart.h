@@ -0,0 +1,77 @@
+// file: MultiHart.h
+
+#ifndef MULTI_HART_H
+#define MULTI_HART_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "CPU.h"
+#include "Coherence.h"
+#include "Program.h"
+#include "SharedMemory.h"
+#include "StoreLog.h"
+
+class QuantumBarrier;
+
+// Several harts running the same program image against one shared data
+// memory. Every hart starts at PC 0 with its hart id in a0.
+class MultiHartSystem {
+private:
+    Program &program;
+    SharedMemory memory;
+    std::vector<CPU *> harts;
+    std::vector<uint64_t> counts;
+    std::vector<uint8_t> limited;     // written by each hart's thread
+    std::atomic<uint64_t> *progress;   // published instruction counts, ~0 once finished
+
+    // deterministic mode
+    std::vector<StoreLog *> logs;
+    std::vector<uint8_t> finished;
+    std::vector<uint8_t> pending_atomic;  // stopped in front of an LR/SC/AMO
+    bool all_finished;
+    uint64_t instruction_limit;
+
+    // optional coherence model, fed at each barrier
+    CoherenceModel *coherence;
+    std::vector<std::vector<uint64_t> > access_logs;  // address << 1 | is_write, all 32 address bits
+
+    uint64_t slowest_active(int self) const;
+    void run_hart(int id, uint64_t quantum, uint64_t max_instructions);
+    bool step_hart(int id);
+    void run_quanta(int id, uint64_t quantum, QuantumBarrier &barrier);
+    void end_quantum();
+    void replay_accesses();
+
+public:
+    MultiHartSystem(Program &program, int num_harts);
+    ~MultiHartSystem();
+
+    // Runs each hart on its own host thread. Harts publish their progress
+    // every `quantum` instructions and stall while they are more than one
+    // quantum ahead of the slowest running hart; 0 lets them run freely.
+    void run_parallel(uint64_t quantum, uint64_t max_instructions);
+
+    // Reproducible variant: every hart runs `quantum` instructions in
+    // parallel against the memory as it was at the last boundary plus its
+    // own store log, then all harts meet at a barrier where the logs are
+    // committed in hart order. An atomic ends its hart's quantum early and
+    // is executed at the barrier, serialized in hart order.
+    void run_deterministic(uint64_t quantum, uint64_t max_instructions);
+    uint64_t quanta;
+
+    // Deterministic mode only: every hart's loads and stores of a quantum are
+    // replayed into the model at the barrier, interleaved round-robin in hart
+    // order. The model is owned by the caller.
+    void attach_coherence(CoherenceModel *model) { coherence = model; }
+
+    int size() const { return (int)harts.size(); }
+    CPU &hart(int id) { return *harts[id]; }
+    SharedMemory &shared_memory() { return memory; }
+    uint64_t get_instructions(int id) const { return counts[id]; }
+
+    void print_results(std::ostream &out) const;
+};
+
+#endif
@@ -0,0 +1,338 @@
+// file: OOOCore.cpp
+
+#include "OOOCore.h"
+#include <iomanip>
+
+static const uint64_t NOT_READY = ~0ULL;
+
+OOOConfig::OOOConfig()
+    : rob_size(64), iq_size(32), lsq_size(32), width(4),
+      alu_units(3), branch_units(1), mem_ports(2),
+      alu_latency(1), branch_latency(1), store_latency(1),
+      load_hit_latency(3), load_miss_latency(30), forward_latency(1),
+      mispredict_penalty(10), perfect_disambiguation(false),
+      cache_size(16384), cache_ways(4), cache_line(64), predictor_entries(4096) {}
+
+static int at_least_one(int value) {
+    return value < 1 ? 1 : value;
+}
+
+static int not_negative(int value) {
+    return value < 0 ? 0 : value;
+}
+
+OOOCore::OOOCore(const OOOConfig &cfg)
+    : config(cfg),
+      dcache(cfg.cache_size, cfg.cache_ways, cfg.cache_line),
+      predictor(cfg.predictor_entries) {
+    config.rob_size = at_least_one(config.rob_size);
+    config.iq_size = at_least_one(config.iq_size);
+    config.lsq_size = at_least_one(config.lsq_size);
+    config.width = at_least_one(config.width);
+    // with no unit of a class nothing of that class could ever issue
+    config.alu_units = at_least_one(config.alu_units);
+    config.branch_units = at_least_one(config.branch_units);
+    config.mem_ports = at_least_one(config.mem_ports);
+    config.alu_latency = not_negative(config.alu_latency);
+    config.branch_latency = not_negative(config.branch_latency);
+    config.store_latency = not_negative(config.store_latency);
+    config.load_hit_latency = not_negative(config.load_hit_latency);
+    config.load_miss_latency = not_negative(config.load_miss_latency);
+    config.forward_latency = not_negative(config.forward_latency);
+    config.mispredict_penalty = not_negative(config.mispredict_penalty);
+    rob.resize(config.rob_size);
+    iq.resize(config.iq_size);
+    lsq.resize(config.lsq_size);
+    rob_head = rob_count = 0;
+    iq_count = 0;
+    lsq_head = lsq_count = 0;
+    for (int i = 0; i < 32; i++) {
+        rename_slot[i] = -1;
+        rename_seq[i] = 0;
+    }
+    now = 0;
+    next_seq = 1;
+    dispatched_this_cycle = 0;
+    blocking_branch = -1;
+    blocking_seq = 0;
+    fetch_resume_cycle = 0;
+
+    committed = 0;
+    rob_occupancy = iq_occupancy = lsq_occupancy = 0;
+    rob_full_cycles = iq_full_cycles = lsq_full_cycles = 0;
+    fetch_stall_cycles = 0;
+    loads_forwarded = 0;
+    load_order_stalls = 0;
+}
+
+// architectural source registers read by an instruction
+static int source_registers(const RetiredInst &inst, int *src) {
+    switch (inst.opcode) {
+        case 0x33: // R-type
+        case 0x23: // stores
+        case 0x63: // BEQ
+        case 0x2F: // atomics
+            src[0] = inst.rs1;
+            src[1] = inst.rs2;
+            return 2;
+        case 0x13: // I-type
+        case 0x03: // loads
+            src[0] = inst.rs1;
+            return 1;
+        default:   // JAL, LUI
+            return 0;
+    }
+}
+
+void OOOCore::dispatch(const RetiredInst &inst) {
+    bool is_mem = inst.memRe || inst.memWr;
+
+    // stall the front end until every structure the instruction needs has room
+    for (;;) {
+        if (blocking_branch >= 0 || now < fetch_resume_cycle) {
+            fetch_stall_cycles++;
+        } else if (dispatched_this_cycle >= config.width) {
+            // group is full, move on to the next cycle
+        } else if (rob_count == config.rob_size) {
+            rob_full_cycles++;
+        } else if (iq_count == config.iq_size) {
+            iq_full_cycles++;
+        } else if (is_mem && lsq_count == config.lsq_size) {
+            lsq_full_cycles++;
+        } else {
+            break;
+        }
+        tick();
+    }
+
+    int slot = (rob_head + rob_count) % config.rob_size;
+    rob_count++;
+    RobEntry &entry = rob[slot];
+    entry.seq = next_seq++;
+    entry.ready_cycle = NOT_READY;
+    entry.issued = false;
+    entry.order_stalled = false;
+    entry.is_load = inst.memRe;
+    entry.is_store = inst.memWr;
+    entry.word = inst.mem_address >> 2;
+    entry.lsq_slot = -1;
+    entry.fu = is_mem ? FU_MEM : (inst.branch ? FU_BRANCH : FU_ALU);
+
+    // rename sources through the producer table
+    int regs[2];
+    int sources = source_registers(inst, regs);
+    for (int i = 0; i < 2; i++) {
+        entry.src[i] = -1;
+        entry.src_seq[i] = 0;
+        if (i < sources && regs[i] != 0 && rename_slot[regs[i]] >= 0) {
+            entry.src[i] = rename_slot[regs[i]];
+            entry.src_seq[i] = rename_seq[regs[i]];
+        }
+    }
+    if (inst.regWrite) {
+        rename_slot[inst.rd] = slot;
+        rename_seq[inst.rd] = entry.seq;
+    }
+
+    iq[iq_count++] = slot;
+
+    if (is_mem) {
+        int lsq_slot = (lsq_head + lsq_count) % config.lsq_size;
+        lsq_count++;
+        lsq[lsq_slot].rob_slot = slot;
+        lsq[lsq_slot].is_store = inst.memWr;
+        lsq[lsq_slot].word = entry.word;
+        entry.lsq_slot = lsq_slot;
+    }
+
+    dispatched_this_cycle++;
+    if (inst.branch) {
+        bool correct = true;
+        if (inst.opcode == 0x63) {
+            correct = predictor.predict_and_update(inst.pc, inst.taken);
+        }
+        if (!correct) {
+            blocking_branch = slot;
+            blocking_seq = entry.seq;
+        } else if (inst.taken) {
+            // a taken branch ends the fetch group
+            dispatched_this_cycle = config.width;
+        }
+    }
+}
+
+void OOOCore::warm(const RetiredInst &inst) {
+    if (inst.opcode == 0x63) {
+        predictor.update(inst.pc, inst.taken);
+    }
+    if (inst.memRe || inst.memWr) {
+        dcache.access(inst.mem_address, inst.memWr);
+    }
+}
+
+bool OOOCore::operand_ready(int slot, uint64_t seq) const {
+    if (slot < 0) {
+        return true;
+    }
+    const RobEntry &producer = rob[slot];
+    if (producer.seq != seq) {
+        return true; // producer already committed
+    }
+    return producer.ready_cycle <= now;
+}
+
+// memory disambiguation: returns the load latency, or -1 if the load has to wait
+int OOOCore::load_latency(RobEntry &entry) {
+    int idx = entry.lsq_slot;
+    while (idx != lsq_head) {
+        idx = (idx + config.lsq_size - 1) % config.lsq_size;
+        const LsqEntry &older = lsq[idx];
+        if (!older.is_store) {
+            continue;
+        }
+        const RobEntry &store = rob[older.rob_slot];
+        if (!store.issued) {
+            // address unknown: conservative ordering waits, perfect ordering
+            // only waits if the store really overlaps
+            if (!config.perfect_disambiguation || older.word == entry.word) {
+                load_order_stalls += !entry.order_stalled;
+                entry.order_stalled = true;
+                return -1;
+            }
+            continue;
+        }
+        if (older.word == entry.word) {
+            if (store.ready_cycle > now) {
+                load_order_stalls += !entry.order_stalled;
+                entry.order_stalled = true;
+                return -1;
+            }
+            loads_forwarded++;
+            return config.forward_latency;
+        }
+    }
+    return dcache.access(entry.word << 2, false) ? config.load_hit_latency : config.load_miss_latency;
+}
+
+void OOOCore::issue() {
+    int free_units[3] = { config.alu_units, config.branch_units, config.mem_ports };
+    int issued = 0;
+    int kept = 0;
+    for (int i = 0; i < iq_count; i++) {
+        int slot = iq[i];
+        RobEntry &entry = rob[slot];
+        bool ready = issued < config.width && free_units[entry.fu] > 0 &&
+                     operand_ready(entry.src[0], entry.src_seq[0]) &&
+                     operand_ready(entry.src[1], entry.src_seq[1]);
+        int latency = 0;
+        if (ready) {
+            if (entry.is_load) {
+                latency = load_latency(entry);
+                ready = latency >= 0;
+            } else if (entry.is_store) {
+                latency = config.store_latency;
+            } else {
+                latency = entry.fu == FU_BRANCH ? config.branch_latency : config.alu_latency;
+            }
+        }
+        if (ready) {
+            entry.issued = true;
+            entry.ready_cycle = now + latency;
+            free_units[entry.fu]--;
+            issued++;
+        } else {
+            iq[kept++] = slot; // compact, keeping age order
+        }
+    }
+    iq_count = kept;
+}
+
+void OOOCore::commit() {
+    for (int i = 0; i < config.width && rob_count > 0; i++) {
+        RobEntry &entry = rob[rob_head];
+        if (entry.ready_cycle > now) {
+            break;
+        }
+        if (entry.is_store) {
+            dcache.access(entry.word << 2, true);
+        }
+        if (entry.lsq_slot >= 0) {
+            lsq_head = (lsq_head + 1) % config.lsq_size;
+            lsq_count--;
+        }
+        rob_head = (rob_head + 1) % config.rob_size;
+        rob_count--;
+        committed++;
+    }
+}
+
+// advances the model by one cycle
+void OOOCore::tick() {
+    now++;
+    dispatched_this_cycle = 0;
+    commit();
+    issue();
+
+    if (blocking_branch >= 0) {
+        const RobEntry &branch = rob[blocking_branch];
+        if (branch.seq != blocking_seq || branch.ready_cycle <= now) {
+            fetch_resume_cycle = now + config.mispredict_penalty;
+            blocking_branch = -1;
+        }
+    }
+
+    rob_occupancy += rob_count;
+    iq_occupancy += iq_count;
+    lsq_occupancy += lsq_count;
+}
+
+// runs until every dispatched instruction has committed
+void OOOCore::drain() {
+    while (rob_count > 0) {
+        tick();
+    }
+}
+
+void OOOCore::accumulate_stats(const OOOCore &other) {
+    now += other.now;
+    committed += other.committed;
+    rob_occupancy += other.rob_occupancy;
+    iq_occupancy += other.iq_occupancy;
+    lsq_occupancy += other.lsq_occupancy;
+    rob_full_cycles += other.rob_full_cycles;
+    iq_full_cycles += other.iq_full_cycles;
+    lsq_full_cycles += other.lsq_full_cycles;
+    fetch_stall_cycles += other.fetch_stall_cycles;
+    loads_forwarded += other.loads_forwarded;
+    load_order_stalls += other.load_order_stalls;
+    predictor.lookups += other.predictor.lookups;
+    predictor.mispredicts += other.predictor.mispredicts;
+    dcache.hits += other.dcache.hits;
+    dcache.misses += other.dcache.misses;
+    dcache.writebacks += other.dcache.writebacks;
+}
+
+void OOOCore::print_stats(std::ostream &out) const {
+    double cycles = now ? (double)now : 1.0;
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "ooo.cycles " << now << std::endl;
+    out << "ooo.instructions " << committed << std::endl;
+    out << "ooo.ipc " << committed / cycles << std::endl;
+    out << "ooo.rob.avg_occupancy " << rob_occupancy / cycles << " / " << config.rob_size << std::endl;
+    out << "ooo.rob.full_cycles " << rob_full_cycles << std::endl;
+    out << "ooo.iq.avg_occupancy " << iq_occupancy / cycles << " / " << config.iq_size << std::endl;
+    out << "ooo.iq.full_cycles " << iq_full_cycles << std::endl;
+    out << "ooo.lsq.avg_occupancy " << lsq_occupancy / cycles << " / " << config.lsq_size << std::endl;
+    out << "ooo.lsq.full_cycles " << lsq_full_cycles << std::endl;
+    out << "ooo.lsq.forwarded " << loads_forwarded << std::endl;
+    out << "ooo.lsq.order_stalls " << load_order_stalls << std::endl;
+    out << "ooo.fetch_stall_cycles " << fetch_stall_cycles << std::endl;
+    out << "ooo.bpred.lookups " << predictor.lookups << std::endl;
+    out << "ooo.bpred.mispredicts " << predictor.mispredicts << std::endl;
+    out << "ooo.dcache.hits " << dcache.hits << std::endl;
+    out << "ooo.dcache.misses " << dcache.misses << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
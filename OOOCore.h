@@ -0,0 +1,123 @@
+// file: OOOCore.h
+
+#ifndef OOO_CORE_H
+#define OOO_CORE_H
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+#include "CPU.h"
+#include "Cache.h"
+#include "BranchPredictor.h"
+
+struct OOOConfig {
+    int rob_size;           // reorder buffer entries
+    int iq_size;            // issue queue entries
+    int lsq_size;           // load/store queue entries
+    int width;              // dispatch, issue and commit width
+    int alu_units;
+    int branch_units;
+    int mem_ports;
+    int alu_latency;
+    int branch_latency;
+    int store_latency;      // address generation for stores
+    int load_hit_latency;
+    int load_miss_latency;
+    int forward_latency;    // store-to-load forwarding
+    int mispredict_penalty; // front-end refill after a mispredicted branch resolves
+    bool perfect_disambiguation; // loads only wait for older stores to the same word
+    int cache_size;
+    int cache_ways;
+    int cache_line;
+    int predictor_entries;
+
+    OOOConfig();
+};
+
+// Trace-driven out-of-order timing model. The functional CPU retires
+// instructions in program order and feeds them to dispatch(); the model
+// renames them into a ROB, issues them out of order from the issue queue as
+// operands and functional units become available, and commits in order.
+// All queues are circular buffers sized once at construction.
+class OOOCore {
+private:
+    enum FuClass { FU_ALU, FU_BRANCH, FU_MEM };
+
+    struct RobEntry {
+        uint64_t seq;           // dispatch sequence number, tells reused slots apart
+        uint64_t ready_cycle;   // cycle the result becomes available
+        int src[2];             // producing ROB slots, -1 when the value is in the register file
+        uint64_t src_seq[2];
+        int lsq_slot;
+        uint32_t word;          // memory word address for loads and stores
+        uint8_t fu;
+        bool is_load;
+        bool is_store;
+        bool issued;
+        bool order_stalled;     // counted in load_order_stalls already
+    };
+
+    struct LsqEntry {
+        int rob_slot;
+        bool is_store;
+        uint32_t word;
+    };
+
+    OOOConfig config;
+    std::vector<RobEntry> rob;
+    std::vector<int> iq;        // ROB slots in age order
+    std::vector<LsqEntry> lsq;
+    int rob_head, rob_count;
+    int iq_count;
+    int lsq_head, lsq_count;
+
+    int rename_slot[32];        // ROB slot producing each architectural register
+    uint64_t rename_seq[32];
+
+    uint64_t now;
+    uint64_t next_seq;
+    int dispatched_this_cycle;
+    int blocking_branch;        // mispredicted branch the front end waits on
+    uint64_t blocking_seq;
+    uint64_t fetch_resume_cycle;
+
+    Cache dcache;
+    BranchPredictor predictor;
+
+    bool operand_ready(int slot, uint64_t seq) const;
+    int load_latency(RobEntry &entry);
+    void commit();
+    void issue();
+
+public:
+    // statistics
+    uint64_t committed;
+    uint64_t rob_occupancy;     // summed every cycle
+    uint64_t iq_occupancy;
+    uint64_t lsq_occupancy;
+    uint64_t rob_full_cycles;   // cycles dispatch stalled on a full structure
+    uint64_t iq_full_cycles;
+    uint64_t lsq_full_cycles;
+    uint64_t fetch_stall_cycles;
+    uint64_t loads_forwarded;
+    uint64_t load_order_stalls; // loads held back by an older store, each counted once
+
+    OOOCore(const OOOConfig &config = OOOConfig());
+
+    void dispatch(const RetiredInst &inst);
+    // functional warming: trains the predictor and cache without timing
+    void warm(const RetiredInst &inst);
+    void tick();
+    void drain();
+
+    uint64_t get_cycles() const { return now; }
+    uint64_t get_committed() const { return committed; }
+    Cache& get_dcache() { return dcache; }
+    BranchPredictor& get_predictor() { return predictor; }
+
+    // adds the statistics of another model, for merging sampled intervals
+    void accumulate_stats(const OOOCore &other);
+    void print_stats(std::ostream &out) const;
+};
+
+#endif
@@ -0,0 +1,157 @@
+// file: ParallelSampler.cpp
+
+#include "ParallelSampler.h"
+#include "Checkpoint.h"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+static std::string checkpoint_name(const std::string &prefix, int index) {
+    std::stringstream name;
+    name << prefix << "." << index;
+    return name.str();
+}
+
+// one step of the main loop: returns whether an instruction retired and
+// clears *running once the program has ended
+static bool step_program(CPU &cpu, Program &program, RetiredInst *retired, bool *running) {
+    bool executed = cpu.step(program.instructions(), retired);
+    *running = executed && cpu.readPC() <= (unsigned long)program.maxPC * 8;
+    return executed;
+}
+
+int write_interval_checkpoints(Program &program, const std::string &prefix, uint64_t interval) {
+    CPU cpu;
+    uint64_t instructions = 0;
+    int written = 0;
+    interval = interval ? interval : 1;
+    bool running = true;
+    while (running) {
+        if (instructions % interval == 0) {
+            if (!save_checkpoint(checkpoint_name(prefix, written).c_str(), cpu, instructions)) {
+                return -1;
+            }
+            written++;
+        }
+        if (step_program(cpu, program, NULL, &running)) {
+            instructions++;
+        }
+    }
+    return written;
+}
+
+struct IntervalJob {
+    std::string checkpoint;     // raw checkpoint bytes
+    uint64_t start;             // instruction count of the checkpoint
+    OOOCore *result;
+    uint64_t instructions;
+};
+
+static void run_interval(Program &program, std::vector<IntervalJob> &jobs, int index,
+                         const ParallelSampleConfig &config) {
+    const IntervalJob &job = jobs[index];
+    uint64_t warm_start = job.start > config.warmup ? job.start - config.warmup : 0;
+
+    // latest checkpoint at or before the warm-up window
+    int base = index;
+    while (base > 0 && jobs[base].start > warm_start) {
+        base--;
+    }
+
+    CPU cpu;
+    OOOCore *core = new OOOCore(config.core);
+    uint64_t count = 0;
+    std::istringstream in(jobs[base].checkpoint);
+    load_checkpoint(in, cpu, &count, core);
+
+    RetiredInst retired;
+    bool running = true;
+    while (running && count < job.start) {
+        if (!step_program(cpu, program, &retired, &running)) {
+            break;
+        }
+        if (count >= warm_start) {
+            core->warm(retired);
+        }
+        count++;
+    }
+    uint64_t executed = 0;
+    while (running && executed < config.interval) {
+        if (!step_program(cpu, program, &retired, &running)) {
+            break;
+        }
+        core->dispatch(retired);
+        executed++;
+    }
+    core->drain();
+
+    jobs[index].result = core;
+    jobs[index].instructions = executed;
+}
+
+bool run_parallel_intervals(Program &program, const std::string &prefix,
+                            const ParallelSampleConfig &config, std::ostream &out) {
+    std::vector<IntervalJob> jobs;
+    // checkpoints are validated against the configured core up front, so
+    // the workers can load them without checking
+    OOOCore scratch_core(config.core);
+    for (int i = 0;; i++) {
+        std::ifstream file(checkpoint_name(prefix, i).c_str(), std::ios::binary);
+        if (!file.is_open()) {
+            break;
+        }
+        IntervalJob job;
+        std::stringstream bytes;
+        bytes << file.rdbuf();
+        job.checkpoint = bytes.str();
+        job.result = NULL;
+        job.instructions = 0;
+
+        CPU scratch;
+        std::istringstream in(job.checkpoint);
+        if (!load_checkpoint(in, scratch, &job.start, &scratch_core)) {
+            std::cerr << "error reading checkpoint " << checkpoint_name(prefix, i) << std::endl;
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    if (jobs.empty()) {
+        return false;
+    }
+
+    // workers pull the next interval until none are left
+    std::atomic<int> next(0);
+    int threads = config.threads;
+    if (threads < 1) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&]() {
+            for (int i = next++; i < (int)jobs.size(); i = next++) {
+                run_interval(program, jobs, i, config);
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+
+    // merge in interval order
+    OOOCore total(config.core);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        OOOCore *core = jobs[i].result;
+        double cycles = core->get_cycles() ? (double)core->get_cycles() : 1.0;
+        out << "interval " << i << " start " << jobs[i].start << " instructions " << jobs[i].instructions
+            << " cycles " << core->get_cycles() << " ipc " << core->get_committed() / cycles << std::endl;
+        total.accumulate_stats(*core);
+        delete core;
+    }
+    total.print_stats(out);
+    return true;
+}
@@ -0,0 +1,35 @@
+// file: ParallelSampler.h
+
+#ifndef PARALLEL_SAMPLER_H
+#define PARALLEL_SAMPLER_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Program.h"
+#include "OOOCore.h"
+
+// Detailed simulation of checkpointed intervals on a pool of worker threads.
+// Interval i starts at the instruction count of checkpoint i and is
+// `interval` instructions long. Each worker restores the latest checkpoint
+// at or before the start of its warm-up window, executes functionally up
+// to the window, warms the predictor and cache for `warmup` instructions
+// and then runs the interval through its own timing model. Results are
+// merged in interval order once every worker has finished.
+struct ParallelSampleConfig {
+    uint64_t interval;
+    uint64_t warmup;
+    int threads;                // 0 = all hardware threads
+    OOOConfig core;
+};
+
+// writes "<prefix>.<n>" every `interval` instructions, starting at 0;
+// returns the number of checkpoints written
+int write_interval_checkpoints(Program &program, const std::string &prefix, uint64_t interval);
+
+// runs every "<prefix>.<n>" checkpoint found on disk; returns false if there are none
+bool run_parallel_intervals(Program &program, const std::string &prefix,
+                            const ParallelSampleConfig &config, std::ostream &out);
+
+#endif
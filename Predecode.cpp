@@ -0,0 +1,134 @@
+// file: Predecode.cpp
+
+#include "Predecode.h"
+#include "CPU.h"
+
+#include <cstdio>
+
+void DecodedProgram::decode(Program &program) {
+    CPU *decoder = new CPU();
+    int slots = program.num_instructions();
+    insts.resize(slots);
+    end_pc = program.maxPC * 4;
+
+    for (int i = 0; i < slots; i++) {
+        // same fetch as CPU::get_instruction at PC = 8 * i
+        decoder->setPC(8 * i);
+        string hex = decoder->get_instruction(program.instructions());
+
+        bool regWrite, aluSrc, branch, memRe, memWr, memToReg, upperIm;
+        int aluOp;
+        unsigned int opcode, rd, funct3, rs1, rs2, funct7;
+        bool running = decoder->decode_instruction(hex, &regWrite, &aluSrc, &branch, &memRe, &memWr, &memToReg,
+            &upperIm, &aluOp, &opcode, &rd, &funct3, &rs1, &rs2, &funct7);
+
+        DecodedInst &inst = insts[i];
+        inst.word = std::stoul(hex, nullptr, 16);
+        inst.imm = decoder->generate_immediate(inst.word, opcode);
+        inst.opcode = opcode;
+        inst.rd = rd;
+        inst.rs1 = rs1;
+        inst.rs2 = rs2;
+        inst.funct3 = funct3;
+        inst.funct7 = funct7;
+        inst.aluOp = aluOp;
+        inst.end = !running;
+        inst.leader = (i == 0);
+    }
+    delete decoder;
+
+    for (int i = 0; i < slots; i++) {
+        if (insts[i].opcode != 0x63 && insts[i].opcode != 0x6F) {
+            continue;
+        }
+        int64_t target = (int64_t)i * 4 + insts[i].imm;
+        if (target >= 0 && target % 4 == 0 && target / 4 < slots) {
+            insts[target / 4].leader = true;
+        }
+        if (i + 1 < slots) {
+            insts[i + 1].leader = true;
+        }
+    }
+    uint32_t length = 0;
+    for (int i = slots - 1; i >= 0; i--) {
+        length++;
+        insts[i].block_length = insts[i].leader ? length : 0;
+        if (insts[i].leader) {
+            length = 0;
+        }
+    }
+}
+
+static const char *register_name(int reg) {
+    static const char *names[32] = {
+        "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15",
+        "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23", "x24", "x25", "x26", "x27", "x28", "x29", "x30", "x31"
+    };
+    return names[reg & 0x1F];
+}
+
+static const char *atomic_name(int funct5) {
+    switch (funct5) {
+        case 0x00: return "amoadd.w";
+        case 0x01: return "amoswap.w";
+        case 0x02: return "lr.w";
+        case 0x03: return "sc.w";
+        case 0x04: return "amoxor.w";
+        case 0x08: return "amoor.w";
+        case 0x0C: return "amoand.w";
+        case 0x10: return "amomin.w";
+        case 0x14: return "amomax.w";
+        case 0x18: return "amominu.w";
+        case 0x1C: return "amomaxu.w";
+        default:   return "amo?.w";
+    }
+}
+
+std::string disassemble(const DecodedInst &inst, uint32_t pc) {
+    char text[64];
+    const char *rd = register_name(inst.rd);
+    const char *rs1 = register_name(inst.rs1);
+    const char *rs2 = register_name(inst.rs2);
+    switch (inst.opcode) {
+        case 0x33:
+            snprintf(text, sizeof(text), "%s %s, %s, %s", inst.aluOp == 0x4 ? "xor" : "add", rd, rs1, rs2);
+            break;
+        case 0x13: {
+            const char *name = inst.aluOp == 0x5 ? "srai" : inst.aluOp == 0x6 ? "ori" : "addi";
+            int32_t imm = inst.aluOp == 0x5 ? (inst.imm & 0x1F) : inst.imm;
+            snprintf(text, sizeof(text), "%s %s, %s, %d", name, rd, rs1, imm);
+            break;
+        }
+        case 0x03:
+            snprintf(text, sizeof(text), "%s %s, %d(%s)", inst.aluOp == 0x8 ? "lb" : "lw", rd, inst.imm, rs1);
+            break;
+        case 0x23:
+            snprintf(text, sizeof(text), "%s %s, %d(%s)", inst.aluOp == 0xA ? "sb" : "sw", rs2, inst.imm, rs1);
+            break;
+        case 0x63:
+            snprintf(text, sizeof(text), "beq %s, %s, 0x%x", rs1, rs2, pc + inst.imm);
+            break;
+        case 0x6F:
+            snprintf(text, sizeof(text), "jal %s, 0x%x", rd, pc + inst.imm);
+            break;
+        case 0x37:
+            snprintf(text, sizeof(text), "lui %s, 0x%x", rd, (uint32_t)inst.imm >> 12);
+            break;
+        case 0x2F: {
+            int funct5 = inst.funct7 >> 2;
+            if (funct5 == 0x02) {
+                snprintf(text, sizeof(text), "lr.w %s, (%s)", rd, rs1);
+            } else {
+                snprintf(text, sizeof(text), "%s %s, %s, (%s)", atomic_name(funct5), rd, rs2, rs1);
+            }
+            break;
+        }
+        case 0x00:
+            snprintf(text, sizeof(text), "end");
+            break;
+        default:
+            snprintf(text, sizeof(text), ".word 0x%08x", inst.word);
+            break;
+    }
+    return text;
+}
@@ -0,0 +1,47 @@
+// file: Predecode.h
+
+#ifndef PREDECODE_H
+#define PREDECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Program.h"
+
+// One instruction slot decoded ahead of time with CPU::decode_instruction
+// and CPU::generate_immediate, so engines that run a program many times
+// skip the per-instruction hex string parsing of the reference path.
+struct DecodedInst {
+    uint32_t word;
+    int32_t imm;
+    uint8_t opcode;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    uint8_t funct3;
+    uint8_t funct7;
+    uint8_t aluOp;
+    bool end;       // NULL instruction, the program stops here
+    bool leader;    // first instruction of a basic block
+    uint32_t block_length;  // leaders: instructions up to the next leader
+};
+
+// "addi x5, x10, 12" style text; branch and jump targets are absolute
+std::string disassemble(const DecodedInst &inst, uint32_t pc);
+
+struct DecodedProgram {
+    std::vector<DecodedInst> insts;  // indexed by byte PC / 4
+    uint32_t end_pc;                 // byte PC past which the main loop stops
+
+    // decodes every instruction slot of the image and marks block leaders:
+    // the entry, every BEQ/JAL target and the instruction after each BEQ/JAL
+    void decode(Program &program);
+
+    // the slot at a byte PC, NULL outside the image
+    const DecodedInst *at(uint32_t pc) const {
+        uint32_t index = pc >> 2;
+        return (pc & 3) == 0 && index < insts.size() ? &insts[index] : 0;
+    }
+};
+
+#endif
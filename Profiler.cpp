@@ -0,0 +1,106 @@
+// file: Profiler.cpp
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+PCProfile::PCProfile(const DecodedProgram &prog)
+    : program(prog), block_entries(prog.insts.size() + 1, 0), counts(prog.insts.size(), 0),
+      cycles(prog.insts.size(), 0) {}
+
+struct HotBlock {
+    size_t first;
+    size_t last;
+    uint64_t entries;
+    uint64_t instructions;
+    uint64_t cycles;
+};
+
+static bool more_instructions(const HotBlock &a, const HotBlock &b) {
+    return a.instructions != b.instructions ? a.instructions > b.instructions : a.first < b.first;
+}
+
+static double percent(uint64_t part, uint64_t total) {
+    return total ? 100.0 * part / total : 0.0;
+}
+
+void PCProfile::report(std::ostream &out, int top) const {
+    // instruction counts: recorded ones plus those implied by block entries
+    size_t slots = counts.size();
+    std::vector<uint64_t> executed(counts);
+    std::vector<HotBlock> blocks;
+    uint64_t current = 0;
+    bool open = false;
+    for (size_t slot = 0; slot < slots; slot++) {
+        const DecodedInst &inst = program.insts[slot];
+        if (inst.end) {
+            // end slots (the whole zero padding after the program) belong to no block
+            open = false;
+            current = 0;
+            continue;
+        }
+        if (inst.leader || !open) {
+            current = block_entries[slot];
+            HotBlock block = { slot, slot, 0, 0, 0 };
+            blocks.push_back(block);
+            open = true;
+        }
+        executed[slot] += current;
+        HotBlock &block = blocks.back();
+        block.last = slot;
+        block.instructions += executed[slot];
+        block.cycles += cycles[slot];
+        if (slot == block.first) {
+            block.entries = executed[slot];
+        }
+        if (inst.opcode == 0x63 || inst.opcode == 0x6F) {
+            current = 0; // nothing falls through into the next slot without a new block entry
+        }
+    }
+
+    uint64_t total = 0;
+    uint64_t total_cycles = 0;
+    std::vector<size_t> order;
+    for (size_t slot = 0; slot < slots; slot++) {
+        total += executed[slot];
+        total_cycles += cycles[slot];
+        if (executed[slot]) {
+            order.push_back(slot);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&executed](size_t a, size_t b) { return executed[a] > executed[b]; });
+    std::stable_sort(blocks.begin(), blocks.end(), more_instructions);
+
+    out << "profile.instructions " << total << std::endl;
+    if (total_cycles) {
+        out << "profile.cycles " << total_cycles << std::endl;
+    }
+    out << std::fixed << std::setprecision(1);
+    for (int i = 0; i < top && i < (int)order.size(); i++) {
+        size_t slot = order[i];
+        out << "profile.pc 0x" << std::hex << std::setw(4) << std::setfill('0') << slot * 4 << std::dec
+            << std::setfill(' ') << " count " << executed[slot] << " (" << percent(executed[slot], total) << "%)";
+        if (total_cycles) {
+            out << " cycles " << cycles[slot] << " (" << percent(cycles[slot], total_cycles) << "%)";
+        }
+        out << "  " << disassemble(program.insts[slot], slot * 4) << std::endl;
+    }
+    for (int i = 0; i < top && i < (int)blocks.size() && blocks[i].instructions; i++) {
+        const HotBlock &block = blocks[i];
+        out << "profile.block 0x" << std::hex << std::setw(4) << std::setfill('0') << block.first * 4 << "-0x"
+            << std::setw(4) << block.last * 4 << std::dec << std::setfill(' ') << " entries " << block.entries
+            << " instructions " << block.instructions << " (" << percent(block.instructions, total) << "%)";
+        if (total_cycles) {
+            out << " cycles " << block.cycles << " (" << percent(block.cycles, total_cycles) << "%)";
+        }
+        out << std::endl;
+        for (size_t slot = block.first; slot <= block.last; slot++) {
+            out << "    0x" << std::hex << std::setw(4) << std::setfill('0') << slot * 4 << std::dec
+                << std::setfill(' ') << "  " << std::setw(10) << executed[slot] << "  "
+                << disassemble(program.insts[slot], slot * 4) << std::endl;
+        }
+    }
+    out << std::defaultfloat;
+}
@@ -0,0 +1,39 @@
+// file: Profiler.h
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "Predecode.h"
+
+// Execution counts per instruction address, and cycles when a timing model
+// runs. Fast runs only count basic block entries (FastEngine::run_profiled)
+// and instruction counts are derived from them; runs through the reference
+// loop record every retired instruction with the cycles its dispatch took.
+class PCProfile {
+private:
+    const DecodedProgram &program;
+    std::vector<uint64_t> block_entries;    // by slot of the block leader
+    std::vector<uint64_t> counts;           // by instruction slot
+    std::vector<uint64_t> cycles;
+
+public:
+    explicit PCProfile(const DecodedProgram &program);
+
+    uint64_t *entries() { return &block_entries[0]; }
+
+    void record(uint32_t pc, uint64_t cycles_spent) {
+        uint32_t slot = pc >> 2;
+        if (slot < counts.size()) {
+            counts[slot]++;
+            cycles[slot] += cycles_spent;
+        }
+    }
+
+    // the hottest instructions and basic blocks, with disassembly
+    void report(std::ostream &out, int top) const;
+};
+
+#endif
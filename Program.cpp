@@ -0,0 +1,40 @@
+// file: Program.cpp
+
+#include "Program.h"
+
+#include <fstream>
+#include <sstream>
+
+static const size_t MIN_IMAGE_SIZE = 4096;
+
+bool load_program(const char *filename, Program &program) {
+    std::ifstream infile(filename);
+    if (!(infile.is_open() && infile.good())) {
+        return false;
+    }
+    load_program(infile, program);
+    return true;
+}
+
+void load_program(std::istream &infile, Program &program) {
+    program.image.clear();
+    std::string line;
+    while (infile >> line) {
+        std::stringstream line2(line);
+        char x = '0';
+        line2 >> x;
+        program.image.push_back(x);
+        x = '0';
+        line2 >> x;
+        program.image.push_back(x);
+    }
+    int i = (int)program.image.size();
+    program.maxPC = i / 4;
+
+    // the main loop may fetch up to PC maxPC * 8 before it stops
+    size_t size = program.maxPC * 8 + 16;
+    if (size < MIN_IMAGE_SIZE) {
+        size = MIN_IMAGE_SIZE;
+    }
+    program.image.resize(size, '0');
+}
@@ -0,0 +1,29 @@
+// file: Program.h
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Instruction memory image as read from the text format: one hex byte per
+// line, stored as two hex characters per byte. The image is padded with
+// '0' so that running off the end decodes as the NULL instruction.
+struct Program {
+    std::vector<char> image;
+    int maxPC;      // loop bound used by the main loop (PC > maxPC * 8 stops)
+
+    Program() : maxPC(0) {}
+
+    char *instructions() { return &image[0]; }
+    // number of 4 byte instruction slots in the image
+    int num_instructions() const { return (int)image.size() / 8; }
+};
+
+// returns false if the file cannot be opened
+bool load_program(const char *filename, Program &program);
+// reads the same text format from any stream
+void load_program(std::istream &in, Program &program);
+
+#endif
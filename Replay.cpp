@@ -0,0 +1,131 @@
+// file: Replay.cpp
+
+#include "Replay.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+void retired_from_record(const TraceRecord &record, RetiredInst &inst) {
+    uint32_t word = record.word;
+    inst.pc = record.pc;
+    inst.inst = word;
+    inst.opcode = word & 0x7F;
+    inst.rd = (word >> 7) & 0x1F;
+    inst.rs1 = (word >> 15) & 0x1F;
+    inst.rs2 = (word >> 20) & 0x1F;
+    inst.aluOp = 0;
+    inst.regWrite = (record.flags & TRACE_REG) != 0;
+    inst.memRe = (record.flags & TRACE_LOAD) != 0;
+    inst.memWr = (record.flags & TRACE_STORE) != 0;
+    inst.branch = inst.opcode == 0x63 || inst.opcode == 0x6F;
+    inst.taken = (record.flags & TRACE_TAKEN) != 0;
+    inst.mem_address = record.mem_address;
+    inst.mem_value = record.mem_value;
+    inst.result = record.value;
+}
+
+uint64_t replay_trace(const MappedTrace &trace, OOOCore &core, uint64_t max_records) {
+    TraceReader reader(trace);
+    TraceRecord record;
+    RetiredInst inst;
+    uint64_t replayed = 0;
+    while ((!max_records || replayed < max_records) && reader.next(record)) {
+        retired_from_record(record, inst);
+        core.dispatch(inst);
+        replayed++;
+    }
+    core.drain();
+    return replayed;
+}
+
+struct ConfigOption {
+    const char *name;
+    int OOOConfig::*field;
+};
+
+static const ConfigOption CONFIG_OPTIONS[] = {
+    { "rob", &OOOConfig::rob_size },
+    { "iq", &OOOConfig::iq_size },
+    { "lsq", &OOOConfig::lsq_size },
+    { "width", &OOOConfig::width },
+    { "alu-units", &OOOConfig::alu_units },
+    { "branch-units", &OOOConfig::branch_units },
+    { "mem-ports", &OOOConfig::mem_ports },
+    { "alu-latency", &OOOConfig::alu_latency },
+    { "branch-latency", &OOOConfig::branch_latency },
+    { "store-latency", &OOOConfig::store_latency },
+    { "load-latency", &OOOConfig::load_hit_latency },
+    { "miss-latency", &OOOConfig::load_miss_latency },
+    { "forward-latency", &OOOConfig::forward_latency },
+    { "mispredict-penalty", &OOOConfig::mispredict_penalty },
+    { "cache-size", &OOOConfig::cache_size },
+    { "cache-ways", &OOOConfig::cache_ways },
+    { "cache-line", &OOOConfig::cache_line },
+    { "predictor-entries", &OOOConfig::predictor_entries },
+};
+
+bool parse_ooo_config(const std::string &line, OOOConfig &config) {
+    std::istringstream tokens(line);
+    std::string token;
+    while (tokens >> token) {
+        if (token.compare(0, 2, "--") == 0) {
+            token = token.substr(2);
+        }
+        if (token == "perfect-disambiguation") {
+            config.perfect_disambiguation = true;
+            continue;
+        }
+        size_t equals = token.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string name = token.substr(0, equals);
+        bool found = false;
+        for (size_t i = 0; i < sizeof(CONFIG_OPTIONS) / sizeof(CONFIG_OPTIONS[0]); i++) {
+            if (name == CONFIG_OPTIONS[i].name) {
+                config.*CONFIG_OPTIONS[i].field = atoi(token.c_str() + equals + 1);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void replay_sweep(const MappedTrace &trace, const std::vector<std::string> &names,
+                  const std::vector<OOOConfig> &configs, int threads, uint64_t max_records,
+                  std::ostream &out) {
+    std::vector<std::string> reports(configs.size());
+    std::vector<uint64_t> replayed(configs.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for (size_t i = 0; i < configs.size(); i++) {
+            pool.submit([&, i]() {
+                OOOCore core(configs[i]);
+                replayed[i] = replay_trace(trace, core, max_records);
+                std::ostringstream report;
+                core.print_stats(report);
+                reports[i] = report.str();
+            });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < configs.size(); i++) {
+        out << "replay.config " << i << " " << names[i] << std::endl;
+        out << "replay.records " << replayed[i] << std::endl;
+        out << reports[i];
+        total += replayed[i];
+    }
+    std::cerr << "replay.seconds " << seconds << std::endl;
+    std::cerr << "replay.records_per_second " << (seconds > 0 ? total / seconds : 0) << std::endl;
+}
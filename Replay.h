@@ -0,0 +1,37 @@
+// file: Replay.h
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CPU.h"
+#include "OOOCore.h"
+#include "Trace.h"
+
+// Trace-driven replay: the timing models consume a binary trace recorded
+// with --trace instead of the functional CPU, so sweeping the core, cache
+// and predictor parameters over one workload costs one replay per
+// configuration and no re-execution.
+
+// rebuilds the retired instruction the engines reported for a record
+void retired_from_record(const TraceRecord &record, RetiredInst &inst);
+
+// dispatches up to max_records records (0 for all) into the core and drains
+// it; returns the number of records replayed
+uint64_t replay_trace(const MappedTrace &trace, OOOCore &core, uint64_t max_records);
+
+// applies "name=value" tokens named like the command-line options
+// (rob=128 width=8 cache-size=32768 ...) on top of config
+bool parse_ooo_config(const std::string &line, OOOConfig &config);
+
+// replays every configuration over the same mapping, in parallel on
+// `threads` workers (0 for every hardware thread), and prints the statistics
+// of each configuration in input order
+void replay_sweep(const MappedTrace &trace, const std::vector<std::string> &names,
+                  const std::vector<OOOConfig> &configs, int threads, uint64_t max_records,
+                  std::ostream &out);
+
+#endif
@@ -0,0 +1,93 @@
+// file: ResultCache.cpp
+
+#include "ResultCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+std::string RunKey::to_string() const {
+    char text[33];
+    snprintf(text, sizeof(text), "%016llx%016llx", (unsigned long long)high, (unsigned long long)low);
+    return text;
+}
+
+static RunKey parse_key(const std::string &text) {
+    RunKey key = { 0, 0 };
+    if (text.size() == 32) {
+        key.high = strtoull(text.substr(0, 16).c_str(), NULL, 16);
+        key.low = strtoull(text.substr(16).c_str(), NULL, 16);
+    }
+    return key;
+}
+
+// two FNV-1a style lanes with different offsets and primes
+RunKey run_key(const Program &program, uint64_t initial_state_hash, uint64_t max_instructions) {
+    uint64_t high = 0xCBF29CE484222325ULL;
+    uint64_t low = 0x84222325CBF29CE4ULL;
+    // the whole image, padding included, since that is what the engines decode
+    size_t length = program.image.size();
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = program.image[i];
+        high = (high ^ c) * 0x100000001B3ULL;
+        low = (low ^ c) * 0x1000000000000B3ULL;
+    }
+    uint64_t extra[4] = { length, initial_state_hash, max_instructions, RESULT_CACHE_SEMANTICS };
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b += 8) {
+            high = (high ^ ((extra[i] >> b) & 0xFF)) * 0x100000001B3ULL;
+            low = (low ^ ((extra[i] >> b) & 0xFF)) * 0x1000000000000B3ULL;
+        }
+    }
+    RunKey key = { high, low };
+    return key;
+}
+
+bool ResultCache::open(const std::string &path) {
+    std::ifstream existing(path.c_str());
+    std::string line;
+    while (std::getline(existing, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::stringstream fields(line);
+        std::string key;
+        RunResult result;
+        fields >> key >> result.status >> result.a0 >> result.a1 >> result.instructions;
+        result.registers[0] = 0;
+        for (int reg = 1; reg < 32; reg++) {
+            fields >> result.registers[reg];
+        }
+        if (fields) {
+            entries[parse_key(key)] = result;
+        }
+    }
+    existing.close();
+
+    file.open(path.c_str(), std::ios::app);
+    return file.is_open();
+}
+
+bool ResultCache::lookup(const RunKey &key, RunResult &result) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::unordered_map<RunKey, RunResult, RunKeyHash>::const_iterator found = entries.find(key);
+    if (found == entries.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    result = found->second;
+    return true;
+}
+
+void ResultCache::store(const RunKey &key, const RunResult &result) {
+    std::lock_guard<std::mutex> guard(lock);
+    entries[key] = result;
+    file << key.to_string() << " " << result.status << " " << result.a0 << " " << result.a1 << " "
+         << result.instructions;
+    for (int reg = 1; reg < 32; reg++) {
+        file << " " << result.registers[reg];
+    }
+    file << "\n";
+    file.flush();
+}
@@ -0,0 +1,59 @@
+// file: ResultCache.h
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Batch.h"
+#include "Program.h"
+
+// 128-bit key of one whole run
+struct RunKey {
+    uint64_t high;
+    uint64_t low;
+
+    bool operator==(const RunKey &other) const { return high == other.high && low == other.low; }
+    std::string to_string() const;
+};
+
+struct RunKeyHash {
+    size_t operator()(const RunKey &key) const { return (size_t)key.low; }
+};
+
+// Version of the simulated semantics mixed into every key. Bump it with any
+// change that can alter a run's result (instruction behaviour, limits, the
+// image layout), so cache files written by older builds stop matching.
+static const uint64_t RESULT_CACHE_SEMANTICS = 2;
+
+// Hashes the whole program image the engines execute, the initial state,
+// the instruction limit and RESULT_CACHE_SEMANTICS, everything that
+// decides a run's result.
+RunKey run_key(const Program &program, uint64_t initial_state_hash, uint64_t max_instructions);
+
+// On-disk cache of whole-run results, one text line per run:
+// "key status a0 a1 instructions x1 .. x31". The file is read once when
+// opened; new results are appended, so several runs can share it.
+class ResultCache {
+private:
+    std::unordered_map<RunKey, RunResult, RunKeyHash> entries;
+    std::ofstream file;
+    std::mutex lock;
+
+public:
+    uint64_t hits;
+    uint64_t misses;
+
+    // false if the file cannot be created
+    bool open(const std::string &path);
+
+    bool lookup(const RunKey &key, RunResult &result);
+    void store(const RunKey &key, const RunResult &result);
+
+    ResultCache() : hits(0), misses(0) {}
+};
+
+#endif
@@ -0,0 +1,306 @@
+// file: Server.cpp
+
+#include "Server.h"
+#include "FastEngine.h"
+#include "Fuzzer.h"
+#include "Predecode.h"
+#include "Program.h"
+#include "ResultCache.h"
+#include "ThreadPool.h"
+
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+struct CachedProgram {
+    Program program;
+    DecodedProgram decoded;
+};
+
+// decoded programs shared by all jobs, oldest evicted first
+class ProgramCache {
+private:
+    std::mutex lock;
+    std::unordered_map<std::string, std::shared_ptr<const CachedProgram> > programs;
+    std::deque<std::string> order;
+    size_t capacity;
+
+    std::shared_ptr<const CachedProgram> insert(const std::string &key, std::shared_ptr<CachedProgram> entry) {
+        entry->decoded.decode(entry->program);
+        std::lock_guard<std::mutex> guard(lock);
+        if (programs.find(key) == programs.end()) {
+            programs[key] = entry;
+            order.push_back(key);
+            while (order.size() > capacity) {
+                programs.erase(order.front());
+                order.pop_front();
+            }
+        }
+        return entry;
+    }
+
+    std::shared_ptr<const CachedProgram> find(const std::string &key) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::unordered_map<std::string, std::shared_ptr<const CachedProgram> >::iterator found = programs.find(key);
+        if (found == programs.end()) {
+            misses++;
+            return std::shared_ptr<const CachedProgram>();
+        }
+        hits++;
+        return found->second;
+    }
+
+public:
+    uint64_t hits;
+    uint64_t misses;
+
+    explicit ProgramCache(size_t entries) : capacity(entries ? entries : 1), hits(0), misses(0) {}
+
+    std::shared_ptr<const CachedProgram> from_file(const std::string &path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            return std::shared_ptr<const CachedProgram>();
+        }
+        std::stringstream key;
+        key << "file:" << path << ":" << info.st_size << ":" << info.st_mtime;
+        std::shared_ptr<const CachedProgram> cached = find(key.str());
+        if (cached) {
+            return cached;
+        }
+        std::shared_ptr<CachedProgram> entry(new CachedProgram());
+        if (!load_program(path.c_str(), entry->program)) {
+            return std::shared_ptr<const CachedProgram>();
+        }
+        return insert(key.str(), entry);
+    }
+
+    // hex digits, two per instruction byte
+    std::shared_ptr<const CachedProgram> from_image(const std::string &hex) {
+        if (hex.size() % 2 != 0) {
+            return std::shared_ptr<const CachedProgram>();
+        }
+        for (size_t i = 0; i < hex.size(); i++) {
+            if (!isxdigit((unsigned char)hex[i])) {
+                return std::shared_ptr<const CachedProgram>();
+            }
+        }
+        std::shared_ptr<CachedProgram> entry(new CachedProgram());
+        std::string text;
+        for (size_t i = 0; i < hex.size(); i += 2) {
+            text += hex.substr(i, 2);
+            text += '\n';
+        }
+        std::istringstream in(text);
+        load_program(in, entry->program);
+        std::string key = "image:" + run_key(entry->program, 0, 0).to_string();
+        std::shared_ptr<const CachedProgram> cached = find(key);
+        return cached ? cached : insert(key, entry);
+    }
+};
+
+// one client: jobs read from in_fd, answers written to out_fd
+struct Connection {
+    int out_fd;
+    std::mutex lock;
+    std::condition_variable done;
+    int pending;
+    bool closed;            // the client went away; later answers are dropped
+
+    explicit Connection(int fd) : out_fd(fd), pending(0), closed(false) {}
+
+    void reply(const std::string &line) {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t written = 0;
+        while (!closed && written < line.size()) {
+            ssize_t count = write(out_fd, line.data() + written, line.size() - written);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                closed = true;
+                break;
+            }
+            written += count;
+        }
+    }
+};
+
+static std::string json_string(const std::string &text) {
+    std::string quoted = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"' || text[i] == '\\') {
+            quoted += '\\';
+        }
+        quoted += text[i];
+    }
+    return quoted + "\"";
+}
+
+static std::string execute_job(const std::string &line, ProgramCache &cache, const ServerConfig &config) {
+    std::stringstream tokens(line);
+    std::string token, id, state;
+    std::shared_ptr<const CachedProgram> program;
+    uint64_t max_instructions = config.max_instructions;
+    std::string error;
+    while (tokens >> token) {
+        if (token.compare(0, 3, "id=") == 0) {
+            id = token.substr(3);
+        } else if (token.compare(0, 8, "program=") == 0) {
+            program = cache.from_file(token.substr(8));
+            if (!program) {
+                error = "cannot load " + token.substr(8);
+            }
+        } else if (token.compare(0, 6, "image=") == 0) {
+            program = cache.from_image(token.substr(6));
+            if (!program) {
+                error = "bad image";
+            }
+        } else if (token.compare(0, 4, "max=") == 0) {
+            max_instructions = strtoull(token.c_str() + 4, NULL, 10);
+        } else {
+            state += token + " ";
+        }
+    }
+    if (max_instructions == 0) {
+        max_instructions = SERVER_DEFAULT_MAX_INSTRUCTIONS;
+    }
+
+    FuzzInput initial;
+    if (error.empty() && !program) {
+        error = "no program";
+    }
+    if (error.empty() && !parse_fuzz_input(state, initial)) {
+        error = "bad state";
+    }
+    std::stringstream out;
+    out << "{\"id\":" << json_string(id);
+    if (!error.empty()) {
+        out << ",\"status\":\"error\",\"error\":" << json_string(error) << "}\n";
+        return out.str();
+    }
+
+    FastEngine engine(program->decoded);
+    for (int reg = 1; reg < 32; reg++) {
+        engine.set_register(reg, initial.regs[reg]);
+    }
+    for (int address = 0; address < FastEngine::MEMORY_SIZE; address++) {
+        if (initial.memory[address]) {
+            engine.write_byte(address, initial.memory[address]);
+        }
+    }
+    engine.run(max_instructions);
+    out << ",\"status\":\"" << (engine.has_finished() ? "ok" : "limit") << "\",\"a0\":" << engine.get_register(10)
+        << ",\"a1\":" << engine.get_register(11) << ",\"instructions\":" << engine.get_instructions() << "}\n";
+    return out.str();
+}
+
+// a job that throws (a program file with malformed bytes, allocation
+// failure) is answered with an error instead of taking the server down
+static std::string run_job(const std::string &line, ProgramCache &cache, const ServerConfig &config) {
+    try {
+        return execute_job(line, cache, config);
+    } catch (const std::exception &e) {
+        std::stringstream tokens(line);
+        std::string token, id;
+        while (tokens >> token) {
+            if (token.compare(0, 3, "id=") == 0) {
+                id = token.substr(3);
+            }
+        }
+        return "{\"id\":" + json_string(id) + ",\"status\":\"error\",\"error\":" + json_string(e.what()) + "}\n";
+    }
+}
+
+// reads jobs until EOF and returns once all of them have been answered
+static void serve_connection(int in_fd, int out_fd, ThreadPool &pool, ProgramCache &cache,
+                             const ServerConfig &config) {
+    Connection connection(out_fd);
+    FILE *in = fdopen(dup(in_fd), "r");
+    if (!in) {
+        return;
+    }
+    char *buffer = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    while ((length = getline(&buffer, &capacity, in)) > 0) {
+        std::string line(buffer, length);
+        if (line.find_first_not_of(" \t\r\n") == std::string::npos) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> guard(connection.lock);
+            connection.pending++;
+        }
+        pool.submit([line, &connection, &cache, &config]() {
+            connection.reply(run_job(line, cache, config));
+            std::lock_guard<std::mutex> guard(connection.lock);
+            if (--connection.pending == 0) {
+                connection.done.notify_all();
+            }
+        });
+    }
+    free(buffer);
+    fclose(in);
+
+    std::unique_lock<std::mutex> guard(connection.lock);
+    while (connection.pending > 0) {
+        connection.done.wait(guard);
+    }
+}
+
+void serve_stream(const ServerConfig &config) {
+    signal(SIGPIPE, SIG_IGN);
+    ThreadPool pool(config.threads);
+    ProgramCache cache(config.cache_programs);
+    serve_connection(0, 1, pool, cache, config);
+    std::cerr << "server.program_cache_hits " << cache.hits << std::endl;
+    std::cerr << "server.program_cache_misses " << cache.misses << std::endl;
+}
+
+bool serve_socket(const std::string &path, const ServerConfig &config) {
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (listener < 0 || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        close(listener);
+        return false;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    ThreadPool pool(config.threads);
+    ProgramCache cache(config.cache_programs);
+    while (true) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+        // one reader per connection; its jobs share the pool
+        std::thread([client, &pool, &cache, &config]() {
+            serve_connection(client, client, pool, cache, config);
+            close(client);
+        }).detach();
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+// file: Server.h
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <cstdint>
+#include <string>
+
+// limit for jobs when neither max= nor ServerConfig::max_instructions gives
+// one, so a looping program cannot hold a worker forever
+static const uint64_t SERVER_DEFAULT_MAX_INSTRUCTIONS = 100000000;
+
+struct ServerConfig {
+    int threads;                // 0 = all hardware threads
+    uint64_t max_instructions;  // limit for jobs without max=, 0 = the default
+    size_t cache_programs;      // decoded programs kept in memory
+
+    ServerConfig() : threads(0), max_instructions(0), cache_programs(256) {}
+};
+
+// Resident simulation server. Jobs arrive one per line:
+//
+//   id=7 program=path/prog.txt max=100000 x10=5 w1024=0x41
+//   id=8 image=130550009305150000 x11=1
+//
+// `program` names a file in the text format, `image` gives the raw
+// instruction bytes in hex; the remaining tokens set the initial state as
+// in --wide. Decoded programs are cached (files by path, size and mtime,
+// images by content hash) and jobs run on a worker pool with the
+// pre-decoded FastEngine. Each job answers with one JSON line, in
+// completion order, carrying its id:
+//
+//   {"id":"7","status":"ok","a0":92,"a1":604,"instructions":23}
+//
+// serve_stream reads jobs from stdin and answers on stdout until EOF.
+// serve_socket listens on a Unix domain socket and serves every
+// connection the same way until the process is terminated. Both ignore
+// SIGPIPE; a client that goes away only loses its own answers.
+void serve_stream(const ServerConfig &config);
+bool serve_socket(const std::string &path, const ServerConfig &config);
+
+#endif
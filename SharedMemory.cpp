@@ -0,0 +1,66 @@
+// file: SharedMemory.cpp
+
+#include "SharedMemory.h"
+#include "ALU.h"
+
+SharedMemory::SharedMemory(int size_bytes) : size(size_bytes) {
+    int count = (size_bytes + 3) / 4;
+    words = new std::atomic<uint32_t>[count];
+    for (int i = 0; i < count; i++) {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+SharedMemory::~SharedMemory() {
+    delete[] words;
+}
+
+int32_t SharedMemory::read(uint32_t address, bool is_byte) const {
+    uint32_t word = words[address >> 2].load(std::memory_order_relaxed);
+    if (is_byte) {
+        return (int8_t)(word >> ((address & 3) * 8));
+    }
+    return (int32_t)word;
+}
+
+void SharedMemory::write(uint32_t address, int32_t value, bool is_byte) {
+    std::atomic<uint32_t> &word = words[address >> 2];
+    if (!is_byte) {
+        word.store(value, std::memory_order_relaxed);
+        return;
+    }
+    int shift = (address & 3) * 8;
+    uint32_t old = word.load(std::memory_order_relaxed);
+    uint32_t updated;
+    do {
+        updated = (old & ~(0xFFu << shift)) | ((uint32_t)(value & 0xFF) << shift);
+    } while (!word.compare_exchange_weak(old, updated, std::memory_order_relaxed));
+}
+
+int32_t SharedMemory::load_reserved(uint32_t address) const {
+    return (int32_t)words[address >> 2].load(std::memory_order_seq_cst);
+}
+
+// succeeds only if the word still holds the value seen by LR
+bool SharedMemory::store_conditional(uint32_t address, int32_t expected, int32_t value) {
+    uint32_t old = expected;
+    return words[address >> 2].compare_exchange_strong(old, value, std::memory_order_seq_cst);
+}
+
+int32_t SharedMemory::atomic_op(uint32_t address, int funct5, int32_t operand) {
+    std::atomic<uint32_t> &word = words[address >> 2];
+    switch (funct5) {
+        case 0x01: return word.exchange(operand);
+        case 0x00: return word.fetch_add(operand);
+        case 0x04: return word.fetch_xor(operand);
+        case 0x0C: return word.fetch_and(operand);
+        case 0x08: return word.fetch_or(operand);
+        default: {
+            // AMOMIN/MAX[U] have no host instruction, use a CAS loop
+            uint32_t old = word.load();
+            while (!word.compare_exchange_weak(old, ALU::atomic_result(funct5, old, operand))) {
+            }
+            return (int32_t)old;
+        }
+    }
+}
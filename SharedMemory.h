@@ -0,0 +1,35 @@
+// file: SharedMemory.h
+
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <atomic>
+#include <cstdint>
+
+// Guest data memory shared by several harts running on host threads.
+// It is stored as host atomic words, so plain loads and stores from
+// different harts never race and the RV32A operations map directly onto
+// host atomic instructions. Byte stores update their word with a CAS loop.
+class SharedMemory {
+private:
+    std::atomic<uint32_t> *words;
+    int size;   // bytes
+
+public:
+    explicit SharedMemory(int size_bytes);
+    ~SharedMemory();
+
+    int get_size() const { return size; }
+
+    // address is checked by the caller
+    int32_t read(uint32_t address, bool is_byte) const;
+    void write(uint32_t address, int32_t value, bool is_byte);
+
+    // word atomics (address must be word aligned)
+    int32_t load_reserved(uint32_t address) const;
+    bool store_conditional(uint32_t address, int32_t expected, int32_t value);
+    // applies AMO funct5 and returns the old value
+    int32_t atomic_op(uint32_t address, int funct5, int32_t operand);
+};
+
+#endif
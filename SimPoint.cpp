@@ -0,0 +1,334 @@
+// file: SimPoint.cpp
+
+#include "SimPoint.h"
+
+#include <cmath>
+#include <string>
+#include <sstream>
+
+static const int PROJECTED_DIMS = 15;
+
+BBVProfiler::BBVProfiler(int num_instructions, uint64_t length)
+    : interval_length(length ? length : 1), in_interval(0), block_start(0), block_length(0),
+      at_block_start(true), counts(num_instructions, 0) {}
+
+void BBVProfiler::end_block() {
+    if (block_length == 0) {
+        return;
+    }
+    if (counts[block_start] == 0) {
+        touched.push_back(block_start);
+    }
+    counts[block_start] += block_length;
+    block_length = 0;
+}
+
+void BBVProfiler::end_interval() {
+    end_block();
+    std::vector<Entry> bbv;
+    bbv.reserve(touched.size());
+    for (size_t i = 0; i < touched.size(); i++) {
+        Entry entry = { touched[i], counts[touched[i]] };
+        bbv.push_back(entry);
+        counts[touched[i]] = 0;
+    }
+    touched.clear();
+    intervals.push_back(bbv);
+    in_interval = 0;
+}
+
+void BBVProfiler::record(const RetiredInst &inst) {
+    if (at_block_start) {
+        block_start = inst.pc / 4;
+        at_block_start = false;
+    }
+    block_length++;
+    if (inst.branch) {
+        end_block();
+        at_block_start = true;
+    }
+    if (++in_interval == interval_length) {
+        end_interval();
+    }
+}
+
+// flushes a trailing partial interval
+void BBVProfiler::finish() {
+    if (in_interval > 0) {
+        end_interval();
+    }
+}
+
+// deterministic random projection weight in [-1, 1] for (block, dim)
+static double projection(uint32_t block, int dim) {
+    uint32_t h = block * 0x9E3779B1u ^ (uint32_t)(dim + 1) * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return (h / 4294967295.0) * 2.0 - 1.0;
+}
+
+static double distance2(const double *a, const double *b) {
+    double sum = 0;
+    for (int d = 0; d < PROJECTED_DIMS; d++) {
+        double diff = a[d] - b[d];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+struct Clustering {
+    int k;
+    std::vector<double> centers;    // k * PROJECTED_DIMS
+    std::vector<int> assignment;
+    double bic;
+};
+
+static uint32_t next_random(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static Clustering kmeans(const std::vector<double> &points, int n, int k, uint32_t seed) {
+    Clustering result;
+    result.k = k;
+    result.centers.assign(k * PROJECTED_DIMS, 0.0);
+    result.assignment.assign(n, -1);
+
+    // k-means++ seeding
+    uint32_t state = seed * 2654435761u + k;
+    std::vector<double> nearest(n, 1e300);
+    int first = next_random(state) % n;
+    for (int d = 0; d < PROJECTED_DIMS; d++) {
+        result.centers[d] = points[first * PROJECTED_DIMS + d];
+    }
+    for (int c = 1; c < k; c++) {
+        double total = 0;
+        for (int i = 0; i < n; i++) {
+            double dist = distance2(&points[i * PROJECTED_DIMS], &result.centers[(c - 1) * PROJECTED_DIMS]);
+            if (dist < nearest[i]) {
+                nearest[i] = dist;
+            }
+            total += nearest[i];
+        }
+        double target = (next_random(state) / 16777216.0) * total;
+        int pick = n - 1;
+        for (int i = 0; i < n; i++) {
+            target -= nearest[i];
+            if (target <= 0) {
+                pick = i;
+                break;
+            }
+        }
+        for (int d = 0; d < PROJECTED_DIMS; d++) {
+            result.centers[c * PROJECTED_DIMS + d] = points[pick * PROJECTED_DIMS + d];
+        }
+    }
+
+    // Lloyd iterations
+    std::vector<int> sizes(k);
+    for (int iteration = 0; iteration < 100; iteration++) {
+        bool changed = false;
+        for (int i = 0; i < n; i++) {
+            int best = 0;
+            double best_dist = 1e300;
+            for (int c = 0; c < k; c++) {
+                double dist = distance2(&points[i * PROJECTED_DIMS], &result.centers[c * PROJECTED_DIMS]);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = c;
+                }
+            }
+            if (result.assignment[i] != best) {
+                result.assignment[i] = best;
+                changed = true;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+        std::vector<double> sums(k * PROJECTED_DIMS, 0.0);
+        sizes.assign(k, 0);
+        for (int i = 0; i < n; i++) {
+            int c = result.assignment[i];
+            sizes[c]++;
+            for (int d = 0; d < PROJECTED_DIMS; d++) {
+                sums[c * PROJECTED_DIMS + d] += points[i * PROJECTED_DIMS + d];
+            }
+        }
+        for (int c = 0; c < k; c++) {
+            if (sizes[c] == 0) {
+                continue; // keep the old center for an empty cluster
+            }
+            for (int d = 0; d < PROJECTED_DIMS; d++) {
+                result.centers[c * PROJECTED_DIMS + d] = sums[c * PROJECTED_DIMS + d] / sizes[c];
+            }
+        }
+    }
+
+    // Bayesian information criterion under a spherical Gaussian model
+    sizes.assign(k, 0);
+    double distortion = 0;
+    for (int i = 0; i < n; i++) {
+        sizes[result.assignment[i]]++;
+        distortion += distance2(&points[i * PROJECTED_DIMS], &result.centers[result.assignment[i] * PROJECTED_DIMS]);
+    }
+    double variance = (n > k) ? distortion / (double)(n - k) : 0.0;
+    if (variance <= 0) {
+        variance = 1e-12;
+    }
+    double likelihood = 0;
+    for (int c = 0; c < k; c++) {
+        double r = sizes[c];
+        if (r == 0) {
+            continue;
+        }
+        likelihood += r * std::log(r) - r * std::log((double)n)
+                    - r * 0.5 * std::log(2.0 * M_PI * variance) * PROJECTED_DIMS
+                    - (r - 1) * PROJECTED_DIMS * 0.5;
+    }
+    double parameters = (k - 1) + PROJECTED_DIMS * k + 1;
+    result.bic = likelihood - parameters * 0.5 * std::log((double)n);
+    return result;
+}
+
+std::vector<SimPointChoice> select_simpoints(const std::vector<std::vector<BBVProfiler::Entry> > &intervals,
+                                             int max_k, uint32_t seed) {
+    std::vector<SimPointChoice> choices;
+    int n = (int)intervals.size();
+    if (n == 0) {
+        return choices;
+    }
+
+    // normalize every vector and project it to PROJECTED_DIMS dimensions
+    std::vector<double> points(n * PROJECTED_DIMS, 0.0);
+    for (int i = 0; i < n; i++) {
+        double total = 0;
+        for (size_t j = 0; j < intervals[i].size(); j++) {
+            total += intervals[i][j].count;
+        }
+        for (size_t j = 0; j < intervals[i].size(); j++) {
+            double share = intervals[i][j].count / total;
+            for (int d = 0; d < PROJECTED_DIMS; d++) {
+                points[i * PROJECTED_DIMS + d] += share * projection(intervals[i][j].block, d);
+            }
+        }
+    }
+
+    if (max_k < 1) max_k = 1;
+    if (max_k > n) max_k = n;
+    std::vector<Clustering> runs;
+    double best_bic = -1e300, worst_bic = 1e300;
+    for (int k = 1; k <= max_k; k++) {
+        runs.push_back(kmeans(points, n, k, seed));
+        if (runs.back().bic > best_bic) best_bic = runs.back().bic;
+        if (runs.back().bic < worst_bic) worst_bic = runs.back().bic;
+    }
+    // smallest k reaching 90% of the BIC range
+    const Clustering *chosen = &runs.back();
+    for (size_t r = 0; r < runs.size(); r++) {
+        if (runs[r].bic >= worst_bic + 0.9 * (best_bic - worst_bic)) {
+            chosen = &runs[r];
+            break;
+        }
+    }
+
+    // representative = interval closest to its cluster center
+    for (int c = 0; c < chosen->k; c++) {
+        int best = -1, size = 0;
+        double best_dist = 1e300;
+        for (int i = 0; i < n; i++) {
+            if (chosen->assignment[i] != c) {
+                continue;
+            }
+            size++;
+            double dist = distance2(&points[i * PROJECTED_DIMS], &chosen->centers[c * PROJECTED_DIMS]);
+            if (dist < best_dist) {
+                best_dist = dist;
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            SimPointChoice choice = { best, (double)size / n, c };
+            choices.push_back(choice);
+        }
+    }
+    return choices;
+}
+
+SampledRun::SampledRun(const std::vector<SimPointChoice> &points, uint64_t length, OOOCore &timing)
+    : core(timing), interval_length(length ? length : 1), current(0), in_interval(0), start_cycles(0),
+      weighted_cpi(0), measured_weight(0), measured(0) {
+    for (size_t i = 0; i < points.size(); i++) {
+        if (points[i].interval < 0) {
+            continue;
+        }
+        if ((size_t)points[i].interval >= weights.size()) {
+            weights.resize(points[i].interval + 1, 0.0);
+        }
+        weights[points[i].interval] = points[i].weight;
+    }
+}
+
+void SampledRun::record(const RetiredInst &inst) {
+    if (current < weights.size() && weights[current] > 0) {
+        if (in_interval == 0) {
+            start_cycles = core.get_cycles();
+        }
+        core.dispatch(inst);
+    }
+    if (++in_interval == interval_length) {
+        end_interval();
+    }
+}
+
+void SampledRun::end_interval() {
+    if (current < weights.size() && weights[current] > 0 && in_interval > 0) {
+        core.drain();
+        double cpi = (double)(core.get_cycles() - start_cycles) / in_interval;
+        weighted_cpi += weights[current] * cpi;
+        measured_weight += weights[current];
+        measured++;
+    }
+    current++;
+    in_interval = 0;
+}
+
+void SampledRun::finish() {
+    if (in_interval > 0) {
+        end_interval();
+    }
+}
+
+void SampledRun::print_stats(std::ostream &out) const {
+    double cpi = measured_weight > 0 ? weighted_cpi / measured_weight : 0.0;
+    out << "simpoint.intervals_measured " << measured << std::endl;
+    out << "simpoint.cpi " << cpi << std::endl;
+    out << "simpoint.ipc " << (cpi > 0 ? 1.0 / cpi : 0.0) << std::endl;
+}
+
+void write_simpoints(std::ostream &out, const std::vector<SimPointChoice> &points) {
+    out << "# interval weight cluster" << std::endl;
+    for (size_t i = 0; i < points.size(); i++) {
+        out << points[i].interval << " " << points[i].weight << " " << points[i].cluster << std::endl;
+    }
+}
+
+bool read_simpoints(std::istream &in, std::vector<SimPointChoice> &points) {
+    std::string line;
+    points.clear();
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::stringstream fields(line);
+        SimPointChoice choice;
+        if (!(fields >> choice.interval >> choice.weight >> choice.cluster)) {
+            return false;
+        }
+        points.push_back(choice);
+    }
+    return true;
+}
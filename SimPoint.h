@@ -0,0 +1,83 @@
+// file: SimPoint.h
+
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include <cstdint>
+#include <vector>
+#include <iostream>
+#include "CPU.h"
+#include "OOOCore.h"
+
+// Collects basic block vectors: for every fixed-length interval of retired
+// instructions, how many instructions were executed in each basic block.
+// Blocks are identified by the index of their first instruction, so the
+// per-interval counts live in a dense array sized to the program.
+class BBVProfiler {
+public:
+    struct Entry {
+        uint32_t block;
+        uint32_t count;
+    };
+
+private:
+    uint64_t interval_length;
+    uint64_t in_interval;
+    uint32_t block_start;
+    uint32_t block_length;
+    bool at_block_start;
+    std::vector<uint32_t> counts;    // current interval, indexed by block
+    std::vector<uint32_t> touched;   // blocks with nonzero counts
+
+    void end_block();
+    void end_interval();
+
+public:
+    std::vector<std::vector<Entry> > intervals; // sparse vector per interval
+
+    BBVProfiler(int num_instructions, uint64_t interval_length);
+
+    void record(const RetiredInst &inst);
+    void finish();
+};
+
+struct SimPointChoice {
+    int interval;   // index of the representative interval
+    double weight;  // fraction of all intervals in its cluster
+    int cluster;
+};
+
+// Projects the vectors to a few dimensions, clusters them with k-means for
+// k = 1..max_k and keeps the smallest k whose BIC score is close to the best.
+std::vector<SimPointChoice> select_simpoints(const std::vector<std::vector<BBVProfiler::Entry> > &intervals,
+                                             int max_k, uint32_t seed = 1);
+
+// Detailed run over the chosen intervals only: instructions of a selected
+// interval go to the timing model, the rest only execute functionally.
+// The whole-program CPI is extrapolated from the weighted interval CPIs.
+class SampledRun {
+private:
+    OOOCore &core;
+    uint64_t interval_length;
+    std::vector<double> weights;    // per interval, 0 when not selected
+    uint64_t current;
+    uint64_t in_interval;
+    uint64_t start_cycles;
+    double weighted_cpi;
+    double measured_weight;
+    int measured;
+
+    void end_interval();
+
+public:
+    SampledRun(const std::vector<SimPointChoice> &points, uint64_t interval_length, OOOCore &core);
+
+    void record(const RetiredInst &inst);
+    void finish();
+    void print_stats(std::ostream &out) const;
+};
+
+void write_simpoints(std::ostream &out, const std::vector<SimPointChoice> &points);
+bool read_simpoints(std::istream &in, std::vector<SimPointChoice> &points);
+
+#endif
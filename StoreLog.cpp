@@ -0,0 +1,58 @@
+// file: StoreLog.cpp
+
+#include "StoreLog.h"
+
+StoreLog::StoreLog(int size_bytes) {
+    int words = (size_bytes + 3) / 4;
+    values.assign(words, 0);
+    masks.assign(words, 0);
+}
+
+int32_t StoreLog::read(const SharedMemory &memory, uint32_t address, bool is_byte) const {
+    uint32_t index = address >> 2;
+    uint32_t word = (uint32_t)memory.read(address & ~3u, false);
+    uint8_t mask = masks[index];
+    if (mask) {
+        for (int b = 0; b < 4; b++) {
+            if (mask & (1 << b)) {
+                word = (word & ~(0xFFu << (b * 8))) | (values[index] & (0xFFu << (b * 8)));
+            }
+        }
+    }
+    if (is_byte) {
+        return (int8_t)(word >> ((address & 3) * 8));
+    }
+    return (int32_t)word;
+}
+
+void StoreLog::write(uint32_t address, int32_t value, bool is_byte) {
+    uint32_t index = address >> 2;
+    if (masks[index] == 0) {
+        dirty.push_back(index);
+    }
+    if (is_byte) {
+        int shift = (address & 3) * 8;
+        values[index] = (values[index] & ~(0xFFu << shift)) | ((uint32_t)(value & 0xFF) << shift);
+        masks[index] |= 1 << (address & 3);
+    } else {
+        values[index] = value;
+        masks[index] = 0xF;
+    }
+}
+
+void StoreLog::commit(SharedMemory &memory) {
+    for (size_t i = 0; i < dirty.size(); i++) {
+        uint32_t index = dirty[i];
+        if (masks[index] == 0xF) {
+            memory.write(index * 4, values[index], false);
+        } else {
+            for (int b = 0; b < 4; b++) {
+                if (masks[index] & (1 << b)) {
+                    memory.write(index * 4 + b, values[index] >> (b * 8), true);
+                }
+            }
+        }
+        masks[index] = 0;
+    }
+    dirty.clear();
+}
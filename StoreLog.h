@@ -0,0 +1,31 @@
+// file: StoreLog.h
+
+#ifndef STORE_LOG_H
+#define STORE_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SharedMemory.h"
+
+// Stores made by one hart during a quantum. The hart reads its own stores
+// back through the log; other harts only see them once the log is
+// committed to the shared memory at the quantum boundary.
+class StoreLog {
+private:
+    std::vector<uint32_t> values;   // per memory word
+    std::vector<uint8_t> masks;     // bytes of the word written this quantum
+    std::vector<uint32_t> dirty;    // indices of written words
+
+public:
+    explicit StoreLog(int size_bytes);
+
+    int32_t read(const SharedMemory &memory, uint32_t address, bool is_byte) const;
+    void write(uint32_t address, int32_t value, bool is_byte);
+
+    // applies the logged stores to memory and empties the log
+    void commit(SharedMemory &memory);
+    size_t size() const { return dirty.size(); }
+};
+
+#endif
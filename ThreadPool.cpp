@@ -0,0 +1,112 @@
+// file: ThreadPool.cpp
+
+#include "ThreadPool.h"
+
+// index of the pool worker running on this thread, -1 elsewhere
+static thread_local int current_worker = -1;
+static thread_local const ThreadPool *current_pool = nullptr;
+
+ThreadPool::ThreadPool(int count) : pending(0), next_queue(0), stopping(false) {
+    if (count <= 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    if (count <= 0) {
+        count = 1;
+    }
+    for (int i = 0; i < count; i++) {
+        workers.push_back(new Worker());
+    }
+    for (int i = 0; i < count; i++) {
+        threads.push_back(std::thread(&ThreadPool::run, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+}
+
+void ThreadPool::submit(const std::function<void()> &task) {
+    int target;
+    if (current_pool == this) {
+        target = current_worker;
+    } else {
+        target = next_queue++ % workers.size();
+    }
+    pending++;
+    {
+        std::lock_guard<std::mutex> guard(workers[target]->lock);
+        workers[target]->tasks.push_back(task);
+    }
+    std::lock_guard<std::mutex> guard(sleep_lock);
+    wake.notify_one();
+}
+
+bool ThreadPool::take(int self, std::function<void()> &task) {
+    {
+        Worker &own = *workers[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); i++) {
+        Worker &victim = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(int self) {
+    current_worker = self;
+    current_pool = this;
+    std::function<void()> task;
+    for (;;) {
+        if (take(self, task)) {
+            task();
+            task = nullptr;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> guard(sleep_lock);
+                idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        if (stopping) {
+            return;
+        }
+        // re-check under the lock so a concurrent submit is not missed
+        bool queued = false;
+        for (size_t i = 0; i < workers.size() && !queued; i++) {
+            std::lock_guard<std::mutex> worker_guard(workers[i]->lock);
+            queued = !workers[i]->tasks.empty();
+        }
+        if (!queued) {
+            wake.wait(guard);
+        }
+    }
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> guard(sleep_lock);
+    while (pending > 0) {
+        idle.wait(guard);
+    }
+}
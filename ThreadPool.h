@@ -0,0 +1,48 @@
+// file: ThreadPool.h
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pops its own
+// newest task first and, when that runs dry, steals the oldest task of
+// another worker. Tasks submitted from outside the pool are spread
+// round-robin over the workers.
+class ThreadPool {
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    std::vector<Worker *> workers;
+    std::vector<std::thread> threads;
+    std::atomic<int> pending;       // submitted but not yet finished
+    std::atomic<unsigned> next_queue;
+    std::mutex sleep_lock;
+    std::condition_variable wake;   // new work or shutdown
+    std::condition_variable idle;   // pending dropped to zero
+    bool stopping;
+
+    bool take(int self, std::function<void()> &task);
+    void run(int self);
+
+public:
+    // threads <= 0 uses every hardware thread
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    void submit(const std::function<void()> &task);
+    // blocks until every submitted task has finished
+    void wait();
+    int size() const { return (int)workers.size(); }
+};
+
+#endif
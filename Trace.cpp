@@ -0,0 +1,258 @@
+// file: Trace.cpp
+
+#include "Trace.h"
+#include "Varint.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// chunks queued for writing before append() waits
+static const size_t MAX_QUEUED_CHUNKS = 8;
+// a record never needs more than this many bytes
+static const size_t MAX_RECORD_SIZE = 1 + 5 + 5 + 1 + 5 + 5 + 5;
+static const size_t CHUNK_HEADER_SIZE = 16;
+
+void TraceState::reset() {
+    pc = (uint32_t)-4;
+    mem_address = 0;
+    memset(regs, 0, sizeof(regs));
+    memset(words, 0, sizeof(words));
+    memset(word_pcs, 0xFF, sizeof(word_pcs));
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    return in[0] | in[1] << 8 | in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+TraceWriter::TraceWriter(std::ostream &stream)
+    : out(stream), records(0), first_record(0), total(0), closing(false) {
+    uint8_t header[16];
+    memcpy(header, "CPUSIMTR", 8);
+    put_u32(header + 8, TRACE_VERSION);
+    put_u32(header + 12, TRACE_CHUNK_SIZE);
+    out.write((const char *)header, sizeof(header));
+    chunk.reserve(CHUNK_HEADER_SIZE + TRACE_CHUNK_SIZE);
+    chunk.resize(CHUNK_HEADER_SIZE);
+    state.reset();
+    writer = std::thread(&TraceWriter::write_loop, this);
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+void TraceWriter::write_loop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        while (full.empty() && !closing) {
+            changed.wait(guard);
+        }
+        if (full.empty()) {
+            break;
+        }
+        std::vector<uint8_t> buffer;
+        buffer.swap(full.front());
+        full.pop_front();
+        changed.notify_all();
+
+        guard.unlock();
+        out.write((const char *)&buffer[0], buffer.size());
+        guard.lock();
+        spare.push_back(std::vector<uint8_t>());
+        spare.back().swap(buffer);
+    }
+    out.flush();
+}
+
+// finishes the current chunk and queues it
+void TraceWriter::seal() {
+    if (records == 0) {
+        return;
+    }
+    put_u32(&chunk[0], chunk.size() - CHUNK_HEADER_SIZE);
+    put_u32(&chunk[4], records);
+    put_u32(&chunk[8], (uint32_t)first_record);
+    put_u32(&chunk[12], (uint32_t)(first_record >> 32));
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (full.size() >= MAX_QUEUED_CHUNKS) {
+        changed.wait(guard);
+    }
+    full.push_back(std::vector<uint8_t>());
+    full.back().swap(chunk);
+    if (!spare.empty()) {
+        chunk.swap(spare.back());
+        spare.pop_back();
+    }
+    changed.notify_all();
+    guard.unlock();
+
+    chunk.clear();
+    chunk.reserve(CHUNK_HEADER_SIZE + TRACE_CHUNK_SIZE);
+    chunk.resize(CHUNK_HEADER_SIZE);
+    first_record += records;
+    records = 0;
+    state.reset();
+}
+
+void TraceWriter::append(const TraceRecord &record) {
+    if (chunk.size() - CHUNK_HEADER_SIZE + MAX_RECORD_SIZE > TRACE_CHUNK_SIZE) {
+        seal();
+    }
+    uint8_t flags = record.flags & TRACE_RECORD_FLAGS;
+    if (record.pc != state.pc + 4) {
+        flags |= TRACE_JUMP;
+    }
+    uint32_t slot = (record.pc >> 2) & 1023;
+    if (state.word_pcs[slot] != record.pc || state.words[slot] != record.word) {
+        flags |= TRACE_WORD;
+        state.word_pcs[slot] = record.pc;
+        state.words[slot] = record.word;
+    }
+    chunk.push_back(flags);
+    if (flags & TRACE_JUMP) {
+        put_varint(chunk, zigzag((int32_t)(record.pc - (state.pc + 4))));
+    }
+    state.pc = record.pc;
+    if (flags & TRACE_WORD) {
+        put_varint(chunk, record.word);
+    }
+    if (flags & TRACE_REG) {
+        uint8_t rd = record.rd & 0x1F;
+        chunk.push_back(rd);
+        put_varint(chunk, zigzag((int32_t)((uint32_t)record.value - (uint32_t)state.regs[rd])));
+        state.regs[rd] = record.value;
+    }
+    if (flags & (TRACE_LOAD | TRACE_STORE)) {
+        put_varint(chunk, zigzag((int32_t)(record.mem_address - state.mem_address)));
+        state.mem_address = record.mem_address;
+        put_varint(chunk, zigzag(record.mem_value));
+    }
+    records++;
+    total++;
+}
+
+void TraceWriter::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    seal();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        closing = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+MappedTrace::MappedTrace(const std::string &path) : data(NULL), length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= 16) {
+        void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = (const uint8_t *)mapped;
+            length = info.st_size;
+            madvise(mapped, length, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+}
+
+MappedTrace::~MappedTrace() {
+    if (data) {
+        munmap((void *)data, length);
+    }
+}
+
+bool MappedTrace::is_open() const {
+    return data && memcmp(data, "CPUSIMTR", 8) == 0 && get_u32(data + 8) == TRACE_VERSION;
+}
+
+TraceReader::TraceReader(const MappedTrace &trace)
+    : data(trace.bytes()), length(trace.is_open() ? trace.size() : 0), offset(16),
+      cursor(NULL), chunk_end(NULL), left(0), index(0) {}
+
+bool TraceReader::next(TraceRecord &record) {
+    while (left == 0) {
+        if (offset + CHUNK_HEADER_SIZE > length) {
+            return false;
+        }
+        const uint8_t *header = data + offset;
+        uint32_t payload = get_u32(header);
+        if (offset + CHUNK_HEADER_SIZE + payload > length) {
+            return false;
+        }
+        left = get_u32(header + 4);
+        index = get_u32(header + 8) | (uint64_t)get_u32(header + 12) << 32;
+        cursor = header + CHUNK_HEADER_SIZE;
+        chunk_end = cursor + payload;
+        offset += CHUNK_HEADER_SIZE + payload;
+        state.reset();
+    }
+
+    if (cursor >= chunk_end) {
+        return false;
+    }
+    uint8_t flags = *cursor++;
+    uint64_t value;
+    record.flags = flags & TRACE_RECORD_FLAGS;
+    record.pc = state.pc + 4;
+    if (flags & TRACE_JUMP) {
+        if (!get_varint(cursor, chunk_end, value)) {
+            return false;
+        }
+        record.pc += (uint32_t)unzigzag(value);
+    }
+    state.pc = record.pc;
+    uint32_t slot = (record.pc >> 2) & 1023;
+    if (flags & TRACE_WORD) {
+        if (!get_varint(cursor, chunk_end, value)) {
+            return false;
+        }
+        state.word_pcs[slot] = record.pc;
+        state.words[slot] = (uint32_t)value;
+    }
+    record.word = state.words[slot];
+    record.rd = 0;
+    record.value = 0;
+    if (flags & TRACE_REG) {
+        if (cursor >= chunk_end) {
+            return false;
+        }
+        record.rd = *cursor++ & 0x1F;
+        if (!get_varint(cursor, chunk_end, value)) {
+            return false;
+        }
+        record.value = (int32_t)((uint32_t)state.regs[record.rd] + (uint32_t)unzigzag(value));
+        state.regs[record.rd] = record.value;
+    }
+    record.mem_address = 0;
+    record.mem_value = 0;
+    if (flags & (TRACE_LOAD | TRACE_STORE)) {
+        if (!get_varint(cursor, chunk_end, value)) {
+            return false;
+        }
+        record.mem_address = state.mem_address + (uint32_t)unzigzag(value);
+        state.mem_address = record.mem_address;
+        if (!get_varint(cursor, chunk_end, value)) {
+            return false;
+        }
+        record.mem_value = (int32_t)unzigzag(value);
+    }
+    left--;
+    index++;
+    return true;
+}
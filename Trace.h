@@ -0,0 +1,145 @@
+// file: Trace.h
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Binary execution trace. The file is a header followed by chunks of at
+// most TRACE_CHUNK_SIZE payload bytes. Each chunk restarts the delta state,
+// so chunks decode independently:
+//
+//   header  "CPUSIMTR", u32 version, u32 chunk size
+//   chunk   u32 payload bytes, u32 records, u64 index of the first record, payload
+//
+// A record is a flags byte followed by the fields it announces, all
+// little-endian varints (signed ones zigzag encoded):
+//
+//   TRACE_JUMP    pc - (previous pc + 4)
+//   TRACE_WORD    instruction word; omitted when it matches the last word
+//                 seen at that pc in the chunk
+//   TRACE_REG     rd, value - last value written to rd in the chunk
+//   TRACE_LOAD / TRACE_STORE (both for atomics)
+//                 address - previous memory address, value
+//   TRACE_TAKEN   no field; the instruction redirected the pc (a taken BEQ
+//                 or JAL), which the next record cannot show for the last one
+
+static const uint32_t TRACE_VERSION = 2;
+static const uint32_t TRACE_CHUNK_SIZE = 65536;
+
+enum TraceFlags {
+    TRACE_JUMP = 1,
+    TRACE_WORD = 2,
+    TRACE_REG = 4,
+    TRACE_LOAD = 8,
+    TRACE_STORE = 16,
+    TRACE_TAKEN = 32
+};
+
+// the flags a TraceRecord carries through the encoding
+static const uint8_t TRACE_RECORD_FLAGS = TRACE_REG | TRACE_LOAD | TRACE_STORE | TRACE_TAKEN;
+
+struct TraceRecord {
+    uint32_t pc;
+    uint32_t word;
+    uint8_t flags;          // TRACE_RECORD_FLAGS
+    uint8_t rd;
+    int32_t value;          // written to rd
+    uint32_t mem_address;
+    int32_t mem_value;
+};
+
+// delta state shared by the encoder and the decoder
+struct TraceState {
+    uint32_t pc;
+    uint32_t mem_address;
+    int32_t regs[32];
+    uint32_t words[1024];   // last word per pc, direct mapped
+    uint32_t word_pcs[1024];
+
+    void reset();
+};
+
+// Encodes records into chunks and hands full chunks to a background thread
+// that writes them, so the simulation thread never waits on the stream
+// unless the writer falls several chunks behind.
+class TraceWriter {
+private:
+    std::ostream &out;
+    std::vector<uint8_t> chunk;
+    uint32_t records;
+    uint64_t first_record;
+    uint64_t total;
+    TraceState state;
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t> > full;     // encoded chunks waiting for the writer
+    std::vector<std::vector<uint8_t> > spare;   // written buffers for reuse
+    bool closing;
+    std::thread writer;
+
+    void write_loop();
+    void seal();
+
+public:
+    explicit TraceWriter(std::ostream &out);
+    ~TraceWriter();
+
+    void append(const TraceRecord &record);
+    // writes the last partial chunk and waits for the writer thread
+    void close();
+
+    uint64_t size() const { return total; }
+};
+
+// A trace file mapped read-only into memory. Any number of readers can
+// decode the same mapping at once.
+class MappedTrace {
+private:
+    const uint8_t *data;
+    size_t length;
+
+    MappedTrace(const MappedTrace &);
+    MappedTrace &operator=(const MappedTrace &);
+
+public:
+    explicit MappedTrace(const std::string &path);
+    ~MappedTrace();
+
+    // true when the file is mapped and has a valid header
+    bool is_open() const;
+    const uint8_t *bytes() const { return data; }
+    size_t size() const { return length; }
+};
+
+// Decodes the records of a mapped trace in order.
+class TraceReader {
+private:
+    const uint8_t *data;
+    size_t length;
+    size_t offset;          // next chunk header
+    const uint8_t *cursor;  // within the current chunk
+    const uint8_t *chunk_end;
+    uint32_t left;          // records left in the current chunk
+    uint64_t index;
+    TraceState state;
+
+public:
+    explicit TraceReader(const MappedTrace &trace);
+
+    // false at the end of the trace or on a corrupt chunk
+    bool next(TraceRecord &record);
+    // index of the record next() returned last
+    uint64_t record_index() const { return index - 1; }
+};
+
+#endif
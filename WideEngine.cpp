@@ -0,0 +1,347 @@
+// file: WideEngine.cpp
+
+#include "WideEngine.h"
+#include "ALU.h"
+#include "Fuzzer.h"
+
+#include <cstring>
+#include <fstream>
+
+// Lanes are padded to whole blocks so the lane loops have a fixed inner
+// trip count and vectorize fully even at -O2.
+static const int LANE_BLOCK = 16;
+
+// On x86-64 Linux with GCC the lane kernels are cloned for AVX-512, AVX2 and
+// the baseline ISA, and the best clone is picked when the program loads.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define LANE_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define LANE_KERNEL
+#endif
+
+LANE_KERNEL
+static void lanes_add(int32_t *__restrict out, const int32_t *__restrict a, const int32_t *__restrict b, int n) {
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = (int32_t)((uint32_t)a[i + j] + (uint32_t)b[i + j]);
+}
+
+LANE_KERNEL
+static void lanes_xor(int32_t *__restrict out, const int32_t *__restrict a, const int32_t *__restrict b, int n) {
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = a[i + j] ^ b[i + j];
+}
+
+LANE_KERNEL
+static void lanes_add_imm(int32_t *__restrict out, const int32_t *__restrict a, int32_t imm, int n) {
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = (int32_t)((uint32_t)a[i + j] + (uint32_t)imm);
+}
+
+LANE_KERNEL
+static void lanes_or_imm(int32_t *__restrict out, const int32_t *__restrict a, int32_t imm, int n) {
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = a[i + j] | imm;
+}
+
+LANE_KERNEL
+static void lanes_sra_imm(int32_t *__restrict out, const int32_t *__restrict a, int32_t imm, int n) {
+    int shamt = imm & 0x1F;
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = a[i + j] >> shamt;
+}
+
+LANE_KERNEL
+static void lanes_fill(int32_t *__restrict out, int32_t value, int n) {
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = value;
+}
+
+LANE_KERNEL
+static void lanes_equal(uint8_t *__restrict out, const int32_t *__restrict a, const int32_t *__restrict b, int n) {
+    for (int i = 0; i < n; i += LANE_BLOCK)
+        for (int j = 0; j < LANE_BLOCK; j++)
+            out[i + j] = a[i + j] == b[i + j];
+}
+
+WideEngine::WideEngine(const DecodedProgram &prog, int lanes)
+    : program(prog), num_lanes(lanes), lockstep_instructions(0), diverged(false) {
+    stride = (lanes + LANE_BLOCK - 1) / LANE_BLOCK * LANE_BLOCK;
+    regs.assign(32 * stride, 0);
+    memory.assign(MEMORY_SIZE * stride, 0);
+    taken.assign(stride, 0);
+    result.assign(stride, 0);
+    pcs.assign(lanes, 0);
+    counts.assign(lanes, 0);
+    limited.assign(lanes, false);
+    reservation.assign(stride, -1);
+}
+
+void WideEngine::set_register(int lane, int reg, int32_t value) {
+    if (reg > 0 && reg < 32) {
+        regs[reg * stride + lane] = value;
+    }
+}
+
+void WideEngine::write_byte(int lane, uint32_t address, uint8_t value) {
+    if (address < (uint32_t)MEMORY_SIZE) {
+        memory[address * stride + lane] = value;
+    }
+}
+
+// one instruction on lanes [begin, end); branch outcomes go to taken[].
+// Whole blocks of lanes use the vector kernels, a single lane runs scalar.
+void WideEngine::execute(const DecodedInst &inst, int begin, int end) {
+    int n = end - begin;
+    bool blocks = n % LANE_BLOCK == 0;
+    int32_t *rd = &regs[inst.rd * stride + begin];
+    const int32_t *rs1 = &regs[inst.rs1 * stride + begin];
+    const int32_t *rs2 = &regs[inst.rs2 * stride + begin];
+    int32_t *result = &this->result[begin];
+    bool write = inst.rd != 0;
+
+    switch (inst.opcode) {
+        case 0x33: // R-type
+            if (blocks && inst.aluOp == 0x0) lanes_add(result, rs1, rs2, n);
+            else if (blocks && inst.aluOp == 0x4) lanes_xor(result, rs1, rs2, n);
+            else for (int i = 0; i < n; i++) result[i] = alu_result(rs1[i], rs2[i], inst.aluOp);
+            break;
+        case 0x13: // I-type
+            if (blocks && inst.aluOp == 0x0) lanes_add_imm(result, rs1, inst.imm, n);
+            else if (blocks && inst.aluOp == 0x6) lanes_or_imm(result, rs1, inst.imm, n);
+            else if (blocks && inst.aluOp == 0x5) lanes_sra_imm(result, rs1, inst.imm, n);
+            else for (int i = 0; i < n; i++) result[i] = alu_result(rs1[i], inst.imm, inst.aluOp);
+            break;
+        case 0x37: // LUI
+            if (blocks) lanes_fill(result, inst.imm, n);
+            else for (int i = 0; i < n; i++) result[i] = inst.imm;
+            break;
+        case 0x63: // BEQ
+            if (blocks) lanes_equal(&taken[begin], rs1, rs2, n);
+            else for (int i = 0; i < n; i++) taken[begin + i] = rs1[i] == rs2[i];
+            write = false;
+            break;
+        case 0x03: // loads gather one lane at a time
+            for (int i = 0; i < n; i++) {
+                uint32_t address = (uint32_t)rs1[i] + (uint32_t)inst.imm;
+                const uint8_t *bytes = &memory[begin + i];
+                result[i] = 0;
+                if (address >= (uint32_t)MEMORY_SIZE) {
+                    continue;
+                }
+                if (inst.aluOp == 0x8) {
+                    result[i] = (int8_t)bytes[address * stride];
+                } else if (inst.aluOp == 0x9 && address % 4 == 0) {
+                    for (int b = 0; b < 4; b++) {
+                        result[i] |= bytes[(address + b) * stride] << (b * 8);
+                    }
+                }
+            }
+            write = write && (inst.aluOp == 0x8 || inst.aluOp == 0x9);
+            break;
+        case 0x23: // stores scatter one lane at a time
+            for (int i = 0; i < n; i++) {
+                uint32_t address = (uint32_t)rs1[i] + (uint32_t)inst.imm;
+                uint8_t *bytes = &memory[begin + i];
+                if (address >= (uint32_t)MEMORY_SIZE) {
+                    continue;
+                }
+                if (inst.aluOp == 0xA) {
+                    bytes[address * stride] = rs2[i] & 0xFF;
+                } else if (inst.aluOp == 0xB && address % 4 == 0) {
+                    for (int b = 0; b < 4; b++) {
+                        bytes[(address + b) * stride] = (rs2[i] >> (b * 8)) & 0xFF;
+                    }
+                }
+            }
+            write = false;
+            break;
+        case 0x2F: // atomics act on each lane's own memory
+            for (int i = 0; i < n; i++) {
+                uint32_t address = (uint32_t)rs1[i];
+                uint8_t *bytes = &memory[begin + i];
+                int64_t &reserved = reservation[begin + i];
+                result[i] = 0;
+                if (address >= (uint32_t)MEMORY_SIZE || address % 4 != 0) {
+                    continue;
+                }
+                int32_t old = 0;
+                for (int b = 0; b < 4; b++) {
+                    old |= bytes[(address + b) * stride] << (b * 8);
+                }
+                int funct5 = inst.funct7 >> 2;
+                int32_t store = 0;
+                bool do_store = true;
+                if (funct5 == 0x02) { // LR.W
+                    reserved = address;
+                    result[i] = old;
+                    do_store = false;
+                } else if (funct5 == 0x03) { // SC.W
+                    do_store = reserved == (int64_t)address;
+                    reserved = -1;
+                    store = rs2[i];
+                    result[i] = do_store ? 0 : 1;
+                } else {
+                    store = ALU::atomic_result(funct5, old, rs2[i]);
+                    result[i] = old;
+                }
+                if (do_store) {
+                    for (int b = 0; b < 4; b++) {
+                        bytes[(address + b) * stride] = (store >> (b * 8)) & 0xFF;
+                    }
+                }
+            }
+            break;
+        default:
+            write = false;
+            break;
+    }
+    if (write) {
+        memcpy(rd, result, n * sizeof(int32_t));
+    }
+}
+
+// scalar continuation of a single lane after divergence
+void WideEngine::run_lane(int lane, uint64_t max_instructions) {
+    uint32_t pc = pcs[lane];
+    uint64_t count = counts[lane];
+    while (pc <= program.end_pc) {
+        if (max_instructions && count >= max_instructions) {
+            limited[lane] = true;
+            break;
+        }
+        const DecodedInst *inst = program.at(pc);
+        if (!inst || inst->end) {
+            break;
+        }
+        uint32_t next = pc + 4;
+        if (inst->opcode == 0x6F) {
+            set_register(lane, inst->rd, pc + 4);
+            next = pc + inst->imm;
+        } else {
+            execute(*inst, lane, lane + 1);
+            if (inst->opcode == 0x63 && taken[lane]) {
+                next = pc + inst->imm;
+            }
+        }
+        count++;
+        pc = next;
+    }
+    pcs[lane] = pc;
+    counts[lane] = count;
+}
+
+void WideEngine::run(uint64_t max_instructions) {
+    uint32_t pc = 0;
+    uint64_t count = 0;
+    while (pc <= program.end_pc) {
+        if (max_instructions && count >= max_instructions) {
+            limited.assign(num_lanes, true);
+            break;
+        }
+        const DecodedInst *inst = program.at(pc);
+        if (!inst || inst->end) {
+            break;
+        }
+        uint32_t next = pc + 4;
+        if (inst->opcode == 0x6F) {
+            if (inst->rd != 0) {
+                lanes_fill(&regs[inst->rd * stride], pc + 4, stride);
+            }
+            next = pc + inst->imm;
+        } else {
+            execute(*inst, 0, stride);
+        }
+        count++;
+
+        if (inst->opcode == 0x63) {
+            bool first = taken[0];
+            bool same = true;
+            for (int lane = 1; lane < num_lanes; lane++) {
+                same = same && taken[lane] == first;
+            }
+            if (!same) {
+                // lanes disagree: finish every lane on its own
+                diverged = true;
+                lockstep_instructions = count;
+                for (int lane = 0; lane < num_lanes; lane++) {
+                    pcs[lane] = taken[lane] ? pc + inst->imm : pc + 4;
+                    counts[lane] = count;
+                }
+                for (int lane = 0; lane < num_lanes; lane++) {
+                    run_lane(lane, max_instructions);
+                }
+                return;
+            }
+            if (first) {
+                next = pc + inst->imm;
+            }
+        }
+        pc = next;
+    }
+    lockstep_instructions = count;
+    for (int lane = 0; lane < num_lanes; lane++) {
+        pcs[lane] = pc;
+        counts[lane] = count;
+    }
+}
+
+bool apply_lane_state(WideEngine &engine, int lane, const std::string &line) {
+    FuzzInput state;
+    if (!parse_fuzz_input(line, state)) {
+        return false;
+    }
+    for (int reg = 1; reg < 32; reg++) {
+        engine.set_register(lane, reg, state.regs[reg]);
+    }
+    for (int address = 0; address < WideEngine::MEMORY_SIZE; address++) {
+        if (state.memory[address]) {
+            engine.write_byte(lane, address, state.memory[address]);
+        }
+    }
+    return true;
+}
+
+bool run_wide(const DecodedProgram &program, const std::string &states_file, uint64_t max_instructions,
+              std::ostream &out) {
+    std::ifstream states(states_file.c_str());
+    if (!states.is_open()) {
+        return false;
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(states, line)) {
+        if (!line.empty() && line[0] == '#') {
+            continue;
+        }
+        lines.push_back(line);
+    }
+    if (lines.empty()) {
+        return false;
+    }
+
+    WideEngine engine(program, lines.size());
+    for (size_t lane = 0; lane < lines.size(); lane++) {
+        if (!apply_lane_state(engine, lane, lines[lane])) {
+            std::cerr << "bad lane state on line " << lane + 1 << ": " << lines[lane] << std::endl;
+            return false;
+        }
+    }
+    engine.run(max_instructions);
+
+    out << "lane,status,a0,a1,instructions\n";
+    for (int lane = 0; lane < engine.lanes(); lane++) {
+        out << lane << "," << (engine.hit_limit(lane) ? "limit" : "ok") << ","
+            << engine.get_register(lane, 10) << "," << engine.get_register(lane, 11) << ","
+            << engine.get_instructions(lane) << "\n";
+    }
+    std::cerr << "wide.lanes " << engine.lanes() << std::endl;
+    std::cerr << "wide.lockstep_instructions " << engine.lockstep_instructions << std::endl;
+    std::cerr << "wide.diverged " << (engine.diverged ? 1 : 0) << std::endl;
+    return true;
+}
@@ -0,0 +1,62 @@
+// file: WideEngine.h
+
+#ifndef WIDE_ENGINE_H
+#define WIDE_ENGINE_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Predecode.h"
+
+// Runs one program on many independent register/memory states at once.
+// Register files and data memories are kept in struct-of-arrays layout
+// (all lanes of x5 are contiguous, as are all lanes of memory byte 16), so
+// each decoded instruction is applied to every lane by one vectorizable
+// loop. Lanes share a PC until a BEQ resolves differently across them;
+// from then on every lane continues on its own, one lane at a time.
+class WideEngine {
+private:
+    const DecodedProgram &program;
+    int num_lanes;
+    int stride;                     // lanes padded to whole kernel blocks
+    std::vector<int32_t> regs;      // regs[reg * lanes + lane]
+    std::vector<uint8_t> memory;    // memory[address * lanes + lane]
+    std::vector<uint8_t> taken;     // per-lane branch outcomes
+    std::vector<int32_t> result;    // per-lane results before writeback
+    std::vector<uint32_t> pcs;      // byte PCs once diverged
+    std::vector<uint64_t> counts;
+    std::vector<bool> limited;
+    std::vector<int64_t> reservation; // LR.W address per lane, -1 when none
+
+    void execute(const DecodedInst &inst, int begin, int end);
+    void run_lane(int lane, uint64_t max_instructions);
+
+public:
+    static const int MEMORY_SIZE = 4096;
+
+    uint64_t lockstep_instructions; // executed before the lanes diverged
+    bool diverged;
+
+    WideEngine(const DecodedProgram &program, int lanes);
+
+    int lanes() const { return num_lanes; }
+    int32_t get_register(int lane, int reg) const { return regs[reg * stride + lane]; }
+    void set_register(int lane, int reg, int32_t value);
+    void write_byte(int lane, uint32_t address, uint8_t value);
+    uint64_t get_instructions(int lane) const { return counts[lane]; }
+    bool hit_limit(int lane) const { return limited[lane]; }
+
+    // runs every lane to completion or max_instructions (0 = no limit)
+    void run(uint64_t max_instructions);
+};
+
+// applies "xN=value", "bADDR=value" (byte) and "wADDR=value" (word) tokens to a
+// lane, parsed by parse_fuzz_input; false on a malformed or out-of-range token
+bool apply_lane_state(WideEngine &engine, int lane, const std::string &line);
+
+// one lane per line of the states file; writes a CSV record per lane
+bool run_wide(const DecodedProgram &program, const std::string &states_file, uint64_t max_instructions,
+              std::ostream &out);
+
+#endif
@@ -0,0 +1,48 @@
+// file: bench/Stats.h
+
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+struct Summary {
+    double min, median, mean, stddev;
+    size_t kept;            // samples left after outlier rejection
+};
+
+// drops samples more than three median absolute deviations away from the
+// median (host noise) before summarizing
+inline Summary summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2];
+    std::vector<double> deviations;
+    for (size_t i = 0; i < samples.size(); i++) {
+        deviations.push_back(fabs(samples[i] - median));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    double mad = deviations[deviations.size() / 2];
+    std::vector<double> kept;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (mad == 0 || fabs(samples[i] - median) <= 3 * mad) {
+            kept.push_back(samples[i]);
+        }
+    }
+    Summary summary;
+    summary.kept = kept.size();
+    summary.min = kept.front();
+    summary.median = kept[kept.size() / 2];
+    double sum = 0, squares = 0;
+    for (size_t i = 0; i < kept.size(); i++) {
+        sum += kept[i];
+    }
+    summary.mean = sum / kept.size();
+    for (size_t i = 0; i < kept.size(); i++) {
+        squares += (kept[i] - summary.mean) * (kept[i] - summary.mean);
+    }
+    summary.stddev = kept.size() > 1 ? sqrt(squares / (kept.size() - 1)) : 0;
+    return summary;
+}
+
+#endif
@@ -0,0 +1,254 @@
+// file: bench/micro.cpp
+//
+// Microbenchmarks of the reference CPU's pipeline stages on randomized
+// inputs: decode, immediate generation, sign extension, data memory reads
+// and writes and the ALU. Each benchmark is warmed up, then timed in
+// batches; batches more than three median absolute deviations from the
+// median are dropped as host noise. Link against libcpusim (see README):
+//
+//   g++ -O2 -pthread -I. bench/micro.cpp libcpusim.a -o micro
+//   ./micro [--samples=N] [--batch=N] [--filter=TEXT]
+
+#include "ALU.h"
+#include "Assembler.h"
+#include "CPU.h"
+#include "Stats.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <time.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const size_t INPUTS = 4096;  // power of two, indexed with a mask
+
+// keeps results alive so the calls are not optimized away
+static volatile int64_t sink;
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// time stamp counter where there is one, nanoseconds otherwise
+static inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return now_ns();
+#endif
+}
+
+// ticks per nanosecond, measured against the monotonic clock
+static double calibrate() {
+    uint64_t start_ns = now_ns(), start_ticks = ticks();
+    while (now_ns() - start_ns < 50000000) {
+    }
+    return (double)(ticks() - start_ticks) / (now_ns() - start_ns);
+}
+
+static uint32_t random_state = 1;
+
+static uint32_t random_u32() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// a random instruction the simulator implements
+static uint32_t random_instruction() {
+    unsigned rd = random_u32() & 31, rs1 = random_u32() & 31, rs2 = random_u32() & 31;
+    int32_t imm = (int32_t)(random_u32() & 0xFFF) - 2048;
+    switch (random_u32() % 10) {
+        case 0: return rv_add(rd, rs1, rs2);
+        case 1: return rv_xor(rd, rs1, rs2);
+        case 2: return rv_addi(rd, rs1, imm);
+        case 3: return rv_ori(rd, rs1, imm);
+        case 4: return rv_srai(rd, rs1, rs2);
+        case 5: return random_u32() & 1 ? rv_lw(rd, rs1, imm) : rv_lb(rd, rs1, imm);
+        case 6: return random_u32() & 1 ? rv_sw(rs2, rs1, imm) : rv_sb(rs2, rs1, imm);
+        case 7: return rv_beq(rs1, rs2, imm * 2);
+        case 8: return rv_jal(rd, (int32_t)(random_u32() & 0xFFFFE) - 0x80000);
+        default: return rv_lui(rd, random_u32());
+    }
+}
+
+struct Inputs {
+    std::vector<std::string> hex;       // instructions as get_instruction returns them
+    std::vector<uint32_t> words;
+    std::vector<int32_t> values;
+    std::vector<int> bits;
+    std::vector<uint32_t> byte_addresses;
+    std::vector<uint32_t> word_addresses;
+    std::vector<int> alu_ops;
+
+    Inputs() {
+        static const int WIDTHS[] = { 8, 12, 13, 21 };
+        static const int ALU_OPS[] = { 0x0, 0x4, 0x5, 0x6, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE };
+        char text[16];
+        for (size_t i = 0; i < INPUTS; i++) {
+            uint32_t word = random_instruction();
+            snprintf(text, sizeof(text), "%08x", word);
+            hex.push_back(text);
+            words.push_back(word);
+            values.push_back((int32_t)random_u32());
+            bits.push_back(WIDTHS[random_u32() % 4]);
+            byte_addresses.push_back(random_u32() % CPU::MEMORY_SIZE);
+            word_addresses.push_back(random_u32() % CPU::MEMORY_SIZE & ~3u);
+            alu_ops.push_back(ALU_OPS[random_u32() % (sizeof(ALU_OPS) / sizeof(ALU_OPS[0]))]);
+        }
+    }
+};
+
+struct Context {
+    Inputs inputs;
+    CPU cpu;
+    ALU alu;
+};
+
+// runs `count` operations starting at input `first`
+typedef void (*BenchFunction)(Context &context, size_t first, size_t count);
+
+static void bench_decode(Context &c, size_t first, size_t count) {
+    bool regWrite, aluSrc, branch, memRe, memWr, memToReg, upperIm;
+    int aluOp;
+    unsigned int opcode, rd, funct3, rs1, rs2, funct7;
+    int64_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        c.cpu.decode_instruction(c.inputs.hex[i & (INPUTS - 1)], &regWrite, &aluSrc, &branch, &memRe, &memWr,
+                                 &memToReg, &upperIm, &aluOp, &opcode, &rd, &funct3, &rs1, &rs2, &funct7);
+        total += aluOp + rd;
+    }
+    sink += total;
+}
+
+static void bench_immediate(Context &c, size_t first, size_t count) {
+    int64_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        uint32_t word = c.inputs.words[i & (INPUTS - 1)];
+        total += c.cpu.generate_immediate(word, word & 0x7F);
+    }
+    sink += total;
+}
+
+static void bench_sign_extend(Context &c, size_t first, size_t count) {
+    int64_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        size_t k = i & (INPUTS - 1);
+        total += c.cpu.sign_extend(c.inputs.values[k], c.inputs.bits[k]);
+    }
+    sink += total;
+}
+
+static void bench_read_byte(Context &c, size_t first, size_t count) {
+    int64_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        total += c.cpu.read_memory(c.inputs.byte_addresses[i & (INPUTS - 1)], true);
+    }
+    sink += total;
+}
+
+static void bench_read_word(Context &c, size_t first, size_t count) {
+    int64_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        total += c.cpu.read_memory(c.inputs.word_addresses[i & (INPUTS - 1)], false);
+    }
+    sink += total;
+}
+
+static void bench_write_byte(Context &c, size_t first, size_t count) {
+    for (size_t i = first; i < first + count; i++) {
+        size_t k = i & (INPUTS - 1);
+        c.cpu.write_memory(c.inputs.byte_addresses[k], c.inputs.values[k], true);
+    }
+}
+
+static void bench_write_word(Context &c, size_t first, size_t count) {
+    for (size_t i = first; i < first + count; i++) {
+        size_t k = i & (INPUTS - 1);
+        c.cpu.write_memory(c.inputs.word_addresses[k], c.inputs.values[k], false);
+    }
+}
+
+static void bench_alu(Context &c, size_t first, size_t count) {
+    int64_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        size_t k = i & (INPUTS - 1);
+        total += c.alu.execute(c.inputs.values[k], c.inputs.values[(k + 1) & (INPUTS - 1)], c.inputs.alu_ops[k]);
+    }
+    sink += total;
+}
+
+struct Benchmark {
+    const char *name;
+    BenchFunction run;
+};
+
+static const Benchmark BENCHMARKS[] = {
+    { "decode_instruction", bench_decode },
+    { "generate_immediate", bench_immediate },
+    { "sign_extend", bench_sign_extend },
+    { "read_memory.byte", bench_read_byte },
+    { "read_memory.word", bench_read_word },
+    { "write_memory.byte", bench_write_byte },
+    { "write_memory.word", bench_write_word },
+    { "alu.execute", bench_alu },
+};
+
+int main(int argc, char *argv[]) {
+    int samples = 51;
+    size_t batch = 16384;
+    const char *filter = "";
+    for (int a = 1; a < argc; a++) {
+        if (strncmp(argv[a], "--samples=", 10) == 0) {
+            samples = atoi(argv[a] + 10);
+        } else if (strncmp(argv[a], "--batch=", 8) == 0) {
+            batch = strtoull(argv[a] + 8, NULL, 10);
+        } else if (strncmp(argv[a], "--filter=", 9) == 0) {
+            filter = argv[a] + 9;
+        } else {
+            fprintf(stderr, "usage: micro [--samples=N] [--batch=N] [--filter=TEXT]\n");
+            return 1;
+        }
+    }
+    if (samples < 1) {
+        samples = 1;
+    }
+    if (batch < 1) {
+        batch = 1;
+    }
+
+    Context *context = new Context();
+    double ticks_per_ns = calibrate();
+    printf("%-20s %9s %9s %9s %9s %9s %7s\n", "benchmark", "ns_min", "ns_median", "ns_mean", "ns_stddev",
+           "ticks", "kept");
+    for (size_t b = 0; b < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); b++) {
+        if (!strstr(BENCHMARKS[b].name, filter)) {
+            continue;
+        }
+        // warm-up: caches, branch predictors and page faults
+        for (int w = 0; w < 3; w++) {
+            BENCHMARKS[b].run(*context, 0, batch);
+        }
+        std::vector<double> per_op;
+        size_t first = 0;
+        for (int s = 0; s < samples; s++) {
+            uint64_t start = ticks();
+            BENCHMARKS[b].run(*context, first, batch);
+            uint64_t elapsed = ticks() - start;
+            per_op.push_back((double)elapsed / batch / ticks_per_ns);
+            first += batch;
+        }
+        Summary summary = summarize(per_op);
+        printf("%-20s %9.3f %9.3f %9.3f %9.3f %9.1f %3zu/%-3d\n", BENCHMARKS[b].name, summary.min, summary.median,
+               summary.mean, summary.stddev, summary.median * ticks_per_ns, summary.kept, samples);
+    }
+    delete context;
+    return 0;
+}
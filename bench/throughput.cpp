@@ -0,0 +1,250 @@
+// file: bench/throughput.cpp
+//
+// Simulator throughput: runs a corpus of guest programs on every engine and
+// reports host nanoseconds per guest instruction and MIPS, with the spread
+// over several repetitions. Link against libcpusim (see README):
+//
+//   g++ -O2 -pthread -I. bench/throughput.cpp libcpusim.a -o throughput
+//   ./throughput [--repetitions=N] [--min-instructions=N] [--csv] [program.txt ...]
+
+#include "Assembler.h"
+#include "Engines.h"
+#include "Predecode.h"
+#include "Program.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Workload {
+    std::string name;
+    Program program;
+    DecodedProgram decoded;
+};
+
+static const char *const ENGINE_NAMES[] = { "reference", "fast" };
+
+// dependent ALU chain, 10 instructions per iteration
+static void alu_loop(Assembler &a, int iterations) {
+    a.li(5, iterations);
+    size_t loop = a.here();
+    a.emit(rv_add(10, 10, 5));
+    a.emit(rv_xor(11, 11, 10));
+    a.emit(rv_addi(12, 12, 7));
+    a.emit(rv_ori(13, 12, 1));
+    a.emit(rv_srai(14, 10, 3));
+    a.emit(rv_add(11, 11, 14));
+    a.emit(rv_xor(10, 10, 13));
+    a.emit(rv_addi(5, 5, -1));
+    size_t exit = a.here();
+    a.beq(5, 0, 0);
+    a.jal(0, loop);
+    a.patch(exit, a.here());
+}
+
+// read-modify-write passes over the whole data memory, unrolled by four
+static void memory_stream(Assembler &a, int passes) {
+    a.li(5, passes);
+    a.li(8, 4096);
+    size_t outer = a.here();
+    a.emit(rv_addi(6, 0, 0));
+    size_t inner = a.here();
+    for (int i = 0; i < 4; i++) {
+        a.emit(rv_lw(7, 6, 4 * i));
+        a.emit(rv_add(7, 7, 6));
+        a.emit(rv_sw(7, 6, 4 * i));
+        a.emit(rv_add(10, 10, 7));
+    }
+    a.emit(rv_addi(6, 6, 16));
+    size_t next = a.here();
+    a.beq(6, 8, 0);
+    a.jal(0, inner);
+    a.patch(next, a.here());
+    a.emit(rv_addi(5, 5, -1));
+    size_t exit = a.here();
+    a.beq(5, 0, 0);
+    a.jal(0, outer);
+    a.patch(exit, a.here());
+}
+
+// loads that depend on the previous load, through a shuffled cycle of 256
+// nodes 16 bytes apart
+static void pointer_chase(Assembler &a, int iterations) {
+    const int nodes = 256;
+    std::vector<int> order(nodes);
+    for (int i = 0; i < nodes; i++) {
+        order[i] = i;
+    }
+    uint32_t seed = 12345;
+    for (int i = nodes - 1; i > 0; i--) {
+        seed = seed * 1103515245 + 12345;
+        std::swap(order[i], order[(seed >> 16) % (i + 1)]);
+    }
+    a.li(9, 2048);
+    for (int i = 0; i < nodes; i++) {
+        int address = order[i] * 16;
+        a.li(7, order[(i + 1) % nodes] * 16);
+        if (address < 2048) {
+            a.emit(rv_sw(7, 0, address));
+        } else {
+            a.emit(rv_sw(7, 9, address - 2048));
+        }
+    }
+    a.li(5, iterations);
+    a.li(6, order[0] * 16);
+    size_t loop = a.here();
+    for (int i = 0; i < 8; i++) {
+        a.emit(rv_lw(6, 6, 0));
+    }
+    a.emit(rv_addi(5, 5, -1));
+    size_t exit = a.here();
+    a.beq(5, 0, 0);
+    a.jal(0, loop);
+    a.patch(exit, a.here());
+    a.emit(rv_add(10, 6, 0));
+}
+
+// a data-dependent branch per byte of a random 0/1 table
+static void branch_heavy(Assembler &a, int passes) {
+    const int size = 1024;
+    uint32_t seed = 777;
+    a.li(1, 1);
+    for (int i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        if (seed >> 30 & 1) {
+            a.emit(rv_sb(1, 0, i));
+        }
+    }
+    a.li(5, passes);
+    a.li(8, size);
+    size_t outer = a.here();
+    a.emit(rv_addi(6, 0, 0));
+    size_t inner = a.here();
+    a.emit(rv_lb(7, 6, 0));
+    size_t skip = a.here();
+    a.beq(7, 0, 0);
+    a.emit(rv_addi(10, 10, 1));
+    a.patch(skip, a.here());
+    a.emit(rv_addi(6, 6, 1));
+    size_t next = a.here();
+    a.beq(6, 8, 0);
+    a.jal(0, inner);
+    a.patch(next, a.here());
+    a.emit(rv_addi(5, 5, -1));
+    size_t exit = a.here();
+    a.beq(5, 0, 0);
+    a.jal(0, outer);
+    a.patch(exit, a.here());
+}
+
+static void add_workload(std::vector<Workload> &corpus, const std::string &name, const Assembler &a) {
+    std::stringstream text;
+    a.write(text);
+    corpus.push_back(Workload());
+    corpus.back().name = name;
+    load_program(text, corpus.back().program);
+}
+
+int main(int argc, char *argv[]) {
+    int repetitions = 7;
+    uint64_t min_instructions = 2000000;
+    bool csv = false;
+    std::vector<std::string> files;
+    for (int a = 1; a < argc; a++) {
+        if (strncmp(argv[a], "--repetitions=", 14) == 0) {
+            repetitions = atoi(argv[a] + 14);
+        } else if (strncmp(argv[a], "--min-instructions=", 19) == 0) {
+            min_instructions = strtoull(argv[a] + 19, NULL, 10);
+        } else if (strcmp(argv[a], "--csv") == 0) {
+            csv = true;
+        } else {
+            files.push_back(argv[a]);
+        }
+    }
+    if (repetitions < 1) {
+        repetitions = 1;
+    }
+    if (files.empty()) {
+        files.push_back("24instMem-r.txt");
+        files.push_back("24instMem-swr.txt");
+        files.push_back("24instMem-jswr.txt");
+    }
+
+    std::vector<Workload> corpus;
+    corpus.reserve(4 + files.size());
+    Assembler alu, stream, chase, branches;
+    alu_loop(alu, 300000);
+    memory_stream(stream, 600);
+    pointer_chase(chase, 270000);
+    branch_heavy(branches, 500);
+    add_workload(corpus, "alu_loop", alu);
+    add_workload(corpus, "memory_stream", stream);
+    add_workload(corpus, "pointer_chase", chase);
+    add_workload(corpus, "branch_heavy", branches);
+    for (size_t i = 0; i < files.size(); i++) {
+        corpus.push_back(Workload());
+        corpus.back().name = files[i];
+        if (!load_program(files[i].c_str(), corpus.back().program)) {
+            fprintf(stderr, "cannot read %s\n", files[i].c_str());
+            return 1;
+        }
+    }
+
+    if (csv) {
+        printf("program,engine,instructions,ns_min,ns_median,ns_mean,ns_stddev,mips\n");
+    } else {
+        printf("%-20s %-10s %12s %9s %9s %9s %9s %9s\n", "program", "engine", "instructions", "ns_min",
+               "ns_median", "ns_mean", "ns_stddev", "mips");
+    }
+    std::ostringstream sink;
+    for (size_t w = 0; w < corpus.size(); w++) {
+        Workload &workload = corpus[w];
+        workload.decoded.decode(workload.program);
+        EngineResult expected = { 0, 0, 0, false };
+        for (size_t e = 0; e < sizeof(ENGINE_NAMES) / sizeof(ENGINE_NAMES[0]); e++) {
+            EngineFunction run = select_engine(ENGINE_NAMES[e], "none");
+            // warm-up run, which also sizes the batch: short programs are
+            // repeated until one sample covers min_instructions
+            EngineResult result = run(workload.program, workload.decoded, 0, sink, NULL);
+            if (e == 0) {
+                expected = result;
+            } else if (result.a0 != expected.a0 || result.a1 != expected.a1 ||
+                       result.instructions != expected.instructions) {
+                fprintf(stderr, "%s: %s disagrees with %s\n", workload.name.c_str(), ENGINE_NAMES[e],
+                        ENGINE_NAMES[0]);
+            }
+            uint64_t runs = result.instructions ? (min_instructions + result.instructions - 1) / result.instructions : 1;
+            if (runs == 0) {
+                runs = 1;
+            }
+
+            std::vector<double> samples;
+            for (int r = 0; r < repetitions; r++) {
+                uint64_t instructions = 0;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (uint64_t i = 0; i < runs; i++) {
+                    instructions += run(workload.program, workload.decoded, 0, sink, NULL).instructions;
+                }
+                double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                samples.push_back(ns / (instructions ? instructions : 1));
+            }
+            Summary s = summarize(samples);
+            double mips = 1000.0 / s.median;
+            if (csv) {
+                printf("%s,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.1f\n", workload.name.c_str(), ENGINE_NAMES[e],
+                       (unsigned long long)result.instructions, s.min, s.median, s.mean, s.stddev, mips);
+            } else {
+                printf("%-20s %-10s %12llu %9.3f %9.3f %9.3f %9.3f %9.1f\n", workload.name.c_str(), ENGINE_NAMES[e],
+                       (unsigned long long)result.instructions, s.min, s.median, s.mean, s.stddev, mips);
+            }
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -1,6 +1,25 @@
 // file: cpusim.cpp
 
 #include "CPU.h"
+#include "OOOCore.h"
+#include "Program.h"
+#include "SimPoint.h"
+#include "Checkpoint.h"
+#include "ParallelSampler.h"
+#include "Batch.h"
+#include "WideEngine.h"
+#include "MultiHart.h"
+#include "ForkServer.h"
+#include "Fuzzer.h"
+#include "Differential.h"
+#include "Server.h"
+#include "FastEngine.h"
+#include "Profiler.h"
+#include "Engines.h"
+#include "Replay.h"
+#include "HostCounters.h"
+#include "LiveStats.h"
+#include "IntervalStats.h"
 
 #include <iostream>
 #include <bitset>
@@ -12,87 +31,561 @@
 using namespace std;
 
 
+// matches "--name=value" and stores the integer value
+static bool int_option(const string &arg, const char *name, int *value)
+{
+	string prefix = string("--") + name + "=";
+	if (arg.compare(0, prefix.size(), prefix) != 0)
+		return false;
+	*value = atoi(arg.c_str() + prefix.size());
+	return true;
+}
+
+// matches "--name=value" and stores the value
+static bool string_option(const string &arg, const char *name, string *value)
+{
+	string prefix = string("--") + name + "=";
+	if (arg.compare(0, prefix.size(), prefix) != 0)
+		return false;
+	*value = arg.substr(prefix.size());
+	return true;
+}
+
 int main(int argc, char* argv[])
 {
 
-	char instMem[4096];
+	// command line: cpusim [options] file
+	const char *filename = NULL;
+	bool ooo = false;
+	OOOConfig oooConfig;
+	string simpointProfile, simpointFile, intervalArg;
+	string fastForwardArg, checkpointIn, checkpointOut;
+	string makeCheckpoints, parallelPrefix, warmupArg;
+	int threads = 0;
+	string batchPath, formatArg, outputFile, maxInstructionsArg, resultCache;
+	string wideStates, quantumArg;
+	int harts = 0;
+	bool deterministic = false;
+	bool coherence = false;
+	CoherenceConfig coherenceConfig;
+	string forkServer;
+	string fuzzDir, fuzzSeeds, fuzzExecutions, seedArg;
+	bool fuzz = false;
+	FuzzConfig fuzzConfig;
+	string differentialStates;
+	string serveSocket;
+	int profileTop = 0;
+	string engineName, instrumentName, traceFile;
+	string replayFile, sweepFile;
+	bool hostCounters = false;
+	string liveStatsFile, intervalStatsFile;
+	bool serve = false;
+	bool differential = false;
+	int maxK = 10;
+	for (int a = 1; a < argc; a++) {
+		string arg = argv[a];
+		if (arg == "--ooo") ooo = true;
+		else if (arg == "--perfect-disambiguation") oooConfig.perfect_disambiguation = true;
+		else if (int_option(arg, "rob", &oooConfig.rob_size)) ooo = true;
+		else if (int_option(arg, "iq", &oooConfig.iq_size)) ooo = true;
+		else if (int_option(arg, "lsq", &oooConfig.lsq_size)) ooo = true;
+		else if (int_option(arg, "width", &oooConfig.width)) ooo = true;
+		else if (int_option(arg, "alu-units", &oooConfig.alu_units)) ooo = true;
+		else if (int_option(arg, "mem-ports", &oooConfig.mem_ports)) ooo = true;
+		else if (int_option(arg, "alu-latency", &oooConfig.alu_latency)) ooo = true;
+		else if (int_option(arg, "load-latency", &oooConfig.load_hit_latency)) ooo = true;
+		else if (int_option(arg, "miss-latency", &oooConfig.load_miss_latency)) ooo = true;
+		else if (int_option(arg, "mispredict-penalty", &oooConfig.mispredict_penalty)) ooo = true;
+		else if (string_option(arg, "simpoint-profile", &simpointProfile)) ;
+		else if (string_option(arg, "simpoints", &simpointFile)) ooo = true;
+		else if (string_option(arg, "interval", &intervalArg)) ;
+		else if (int_option(arg, "max-k", &maxK)) ;
+		else if (string_option(arg, "fast-forward", &fastForwardArg)) ;
+		else if (string_option(arg, "checkpoint-in", &checkpointIn)) ;
+		else if (string_option(arg, "checkpoint-out", &checkpointOut)) ;
+		else if (string_option(arg, "make-checkpoints", &makeCheckpoints)) ;
+		else if (string_option(arg, "parallel", &parallelPrefix)) ;
+		else if (string_option(arg, "warmup", &warmupArg)) ;
+		else if (int_option(arg, "threads", &threads)) ;
+		else if (string_option(arg, "batch", &batchPath)) ;
+		else if (string_option(arg, "format", &formatArg)) ;
+		else if (string_option(arg, "output", &outputFile)) ;
+		else if (string_option(arg, "result-cache", &resultCache)) ;
+		else if (string_option(arg, "max-instructions", &maxInstructionsArg)) ;
+		else if (string_option(arg, "wide", &wideStates)) ;
+		else if (int_option(arg, "harts", &harts)) ;
+		else if (string_option(arg, "quantum", &quantumArg)) ;
+		else if (arg == "--deterministic") deterministic = true;
+		else if (arg == "--coherence") coherence = true;
+		else if (arg == "--fork-server") forkServer = "fork";
+		else if (string_option(arg, "fork-server", &forkServer)) ;
+		else if (arg == "--fuzz") fuzz = true;
+		else if (string_option(arg, "fuzz", &fuzzDir)) fuzz = true;
+		else if (string_option(arg, "fuzz-seeds", &fuzzSeeds)) fuzz = true;
+		else if (string_option(arg, "fuzz-executions", &fuzzExecutions)) fuzz = true;
+		else if (int_option(arg, "fuzz-memory", &fuzzConfig.memory_window)) fuzz = true;
+		else if (string_option(arg, "seed", &seedArg)) ;
+		else if (arg == "--differential") differential = true;
+		else if (arg == "--serve") serve = true;
+		else if (arg == "--profile") profileTop = 10;
+		else if (string_option(arg, "engine", &engineName)) ;
+		else if (string_option(arg, "instrument", &instrumentName)) ;
+		else if (string_option(arg, "trace", &traceFile)) instrumentName = "binary";
+		else if (string_option(arg, "replay", &replayFile)) ;
+		else if (string_option(arg, "sweep", &sweepFile)) ;
+		else if (arg == "--host-counters") hostCounters = true;
+		else if (string_option(arg, "live-stats", &liveStatsFile)) ;
+		else if (string_option(arg, "interval-stats", &intervalStatsFile)) ;
+		else if (int_option(arg, "profile", &profileTop)) ;
+		else if (string_option(arg, "serve", &serveSocket)) serve = true;
+		else if (string_option(arg, "differential", &differentialStates)) differential = true;
+		else if (int_option(arg, "l1-size", &coherenceConfig.cache_size)) coherence = true;
+		else if (int_option(arg, "l1-ways", &coherenceConfig.ways)) coherence = true;
+		else if (int_option(arg, "l1-line", &coherenceConfig.line_bytes)) coherence = true;
+		else if (arg.compare(0, 2, "--") == 0) {
+			cout << "Unknown option " << arg << endl;
+			return -1;
+		}
+		else filename = argv[a];
+	}
+
+	// live statistics come from the main loop and the single-program engines only
+	if (!liveStatsFile.empty() && (!batchPath.empty() || serve || !replayFile.empty() || !wideStates.empty() ||
+		!forkServer.empty() || differential || fuzz || !makeCheckpoints.empty() || !parallelPrefix.empty() ||
+		harts > 0 || hostCounters)) {
+		cout << "--live-stats is not supported in this mode" << endl;
+		return -1;
+	}
+
+	// batch mode: many programs in this process, one CSV/JSON stream
+	if (!batchPath.empty()) {
+		BatchConfig batchConfig;
+		batchConfig.threads = threads;
+		batchConfig.max_instructions = strtoull(maxInstructionsArg.c_str(), NULL, 10);
+		batchConfig.json = (formatArg == "json");
+		batchConfig.cache_file = resultCache;
+		vector<string> programs;
+		if (!list_batch_programs(batchPath, programs)) {
+			cout << "error opening batch " << batchPath << endl;
+			return -1;
+		}
+		if (outputFile.empty()) {
+			run_batch(programs, batchConfig, cout);
+		}
+		else {
+			ofstream out(outputFile.c_str());
+			run_batch(programs, batchConfig, out);
+		}
+		return 0;
+	}
+
+	// resident server: jobs over stdin or a Unix domain socket
+	if (serve) {
+		ServerConfig serverConfig;
+		serverConfig.threads = threads;
+		serverConfig.max_instructions = strtoull(maxInstructionsArg.c_str(), NULL, 10);
+		if (serveSocket.empty()) {
+			serve_stream(serverConfig);
+		}
+		else if (!serve_socket(serveSocket, serverConfig)) {
+			cout << "cannot listen on " << serveSocket << endl;
+			return -1;
+		}
+		return 0;
+	}
 
+	// timing models fed from a recorded trace, one replay per configuration
+	if (!replayFile.empty()) {
+		MappedTrace trace(replayFile);
+		if (!trace.is_open()) {
+			cout << "error reading trace " << replayFile << endl;
+			return -1;
+		}
+		vector<string> names;
+		vector<OOOConfig> configs;
+		if (sweepFile.empty()) {
+			names.push_back("-");
+			configs.push_back(oooConfig);
+		}
+		else {
+			ifstream sweep(sweepFile.c_str());
+			string line;
+			while (getline(sweep, line)) {
+				if (line.empty() || line[0] == '#')
+					continue;
+				OOOConfig config = oooConfig;
+				if (!parse_ooo_config(line, config)) {
+					cout << "bad configuration: " << line << endl;
+					return -1;
+				}
+				names.push_back(line);
+				configs.push_back(config);
+			}
+			if (configs.empty()) {
+				cout << "error reading sweep " << sweepFile << endl;
+				return -1;
+			}
+		}
+		replay_sweep(trace, names, configs, threads, strtoull(maxInstructionsArg.c_str(), NULL, 10), cout);
+		return 0;
+	}
 
-	if (argc < 2) {
+	if (filename == NULL) {
 		cout << "No file name entered. Exiting...";
 		return -1;
 	}
 
-	ifstream infile(argv[1]); //open the file
-	if (!(infile.is_open() && infile.good())) {
+	Program program;
+	if (!load_program(filename, program)) {
 		cout<<"error opening file\n";
 		return 0; 
 	}
-	string line; 
-	int i = 0;
-	while (infile) {
-			infile>>line;
-			stringstream line2(line);
-			char x; 
-			line2>>x;
-			instMem[i] = x; // be careful about hex
-			i++;
-			line2>>x;
-			instMem[i] = x; // be careful about hex
-			i++;
-		}
-	int maxPC= i/4; 
-	
+	int maxPC = program.maxPC;
+	uint64_t interval = intervalArg.empty() ? 1000000 : strtoull(intervalArg.c_str(), NULL, 10);
+	if (interval == 0) {
+		cout << "--interval must be at least 1" << endl;
+		return -1;
+	}
+	uint64_t fastForward = strtoull(fastForwardArg.c_str(), NULL, 10);
+
+	// lockstep execution of one program over many initial states
+	if (!wideStates.empty()) {
+		DecodedProgram decoded;
+		decoded.decode(program);
+		if (!run_wide(decoded, wideStates, strtoull(maxInstructionsArg.c_str(), NULL, 10), cout)) {
+			cout << "error reading lane states " << wideStates << endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	// one forked run per request line on stdin
+	if (!forkServer.empty()) {
+		DecodedProgram decoded;
+		decoded.decode(program);
+		ForkServerStats stats = run_fork_server(decoded, strtoull(maxInstructionsArg.c_str(), NULL, 10),
+			forkServer != "snapshot", cin, cout);
+		cerr << "forkserver.requests " << stats.requests << endl;
+		cerr << "forkserver.crashes " << stats.crashes << endl;
+		return 0;
+	}
+
+	// reference and pre-decoded engines side by side, one run per initial state
+	if (differential) {
+		DecodedProgram decoded;
+		decoded.decode(program);
+		vector<FuzzInput> states(1);
+		if (!differentialStates.empty()) {
+			states.clear();
+			ifstream stateFile(differentialStates.c_str());
+			string line;
+			while (getline(stateFile, line)) {
+				FuzzInput input;
+				if (line.empty() || line[0] == '#')
+					continue;
+				if (!parse_fuzz_input(line, input)) {
+					cout << "bad state: " << line << endl;
+					return -1;
+				}
+				states.push_back(input);
+			}
+		}
+		int diverged = 0;
+		for (size_t i = 0; i < states.size(); i++) {
+			if (states.size() > 1)
+				cout << "diff.state " << i << endl;
+			diverged += run_differential(program, decoded, states[i], strtoull(maxInstructionsArg.c_str(), NULL, 10), cout).diverged;
+		}
+		return diverged ? 1 : 0;
+	}
+
+	// coverage-guided fuzzing of the initial registers and memory
+	if (fuzz) {
+		fuzzConfig.threads = threads;
+		fuzzConfig.output_dir = fuzzDir;
+		if (!fuzzExecutions.empty())
+			fuzzConfig.executions = strtoull(fuzzExecutions.c_str(), NULL, 10);
+		if (!maxInstructionsArg.empty())
+			fuzzConfig.max_instructions = strtoull(maxInstructionsArg.c_str(), NULL, 10);
+		if (!seedArg.empty())
+			fuzzConfig.seed = strtoull(seedArg.c_str(), NULL, 10);
+		vector<FuzzInput> seeds;
+		if (!fuzzSeeds.empty()) {
+			ifstream seedFile(fuzzSeeds.c_str());
+			string line;
+			while (getline(seedFile, line)) {
+				FuzzInput input;
+				if (line.empty() || line[0] == '#')
+					continue;
+				if (!parse_fuzz_input(line, input)) {
+					cout << "bad seed: " << line << endl;
+					return -1;
+				}
+				seeds.push_back(input);
+			}
+		}
+		print_fuzz_stats(run_fuzzer(program, seeds, fuzzConfig), cout);
+		return 0;
+	}
+
+	if (!makeCheckpoints.empty()) {
+		int written = write_interval_checkpoints(program, makeCheckpoints, interval);
+		if (written < 0) {
+			cout << "error writing checkpoints " << makeCheckpoints << endl;
+			return -1;
+		}
+		cout << written << " checkpoints " << makeCheckpoints << ".0 .. " << makeCheckpoints << "." << written - 1 << endl;
+		return 0;
+	}
+	if (!parallelPrefix.empty()) {
+		ParallelSampleConfig sampleConfig;
+		sampleConfig.interval = interval;
+		sampleConfig.warmup = strtoull(warmupArg.c_str(), NULL, 10);
+		sampleConfig.threads = threads ? threads : 1;	// one worker unless --threads is given
+		sampleConfig.core = oooConfig;
+		if (!run_parallel_intervals(program, parallelPrefix, sampleConfig, cout)) {
+			cout << "no checkpoints " << parallelPrefix << ".0 .." << endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	// several harts sharing one data memory, one host thread each
+	if (harts > 0) {
+		if (coherence && harts > MAX_COHERENT_CORES) {
+			cout << "--coherence supports at most " << MAX_COHERENT_CORES << " harts" << endl;
+			return -1;
+		}
+		MultiHartSystem system(program, harts);
+		uint64_t quantum = strtoull(quantumArg.c_str(), NULL, 10);
+		uint64_t maxInstructions = strtoull(maxInstructionsArg.c_str(), NULL, 10);
+		// the coherence model is fed at quantum barriers, so it implies --deterministic
+		CoherenceModel *model = coherence ? new CoherenceModel(harts, coherenceConfig) : NULL;
+		system.attach_coherence(model);
+		if (deterministic || coherence)
+			system.run_deterministic(quantum ? quantum : 10000, maxInstructions);
+		else
+			system.run_parallel(quantum, maxInstructions);
+		system.print_results(cout);
+		if (model) {
+			model->print_stats(cout);
+			delete model;
+		}
+		return 0;
+	}
+
+	// host perf counters around each engine and each phase of CPU::step
+	if (hostCounters) {
+		DecodedProgram decoded;
+		decoded.decode(program);
+		ostringstream report;
+		EngineResult result = run_host_counters(program, decoded, strtoull(maxInstructionsArg.c_str(), NULL, 10), report);
+		cout << "(" << result.a0 << "," << result.a1 << ")" << endl;
+		cout << report.str();
+		return 0;
+	}
+
+	// an engine instantiated for one instrumentation policy
+	if (!engineName.empty() || !instrumentName.empty()) {
+		EngineFunction run = select_engine(engineName.empty() ? "reference" : engineName,
+			instrumentName.empty() ? "none" : instrumentName);
+		if (!run) {
+			cout << "Unknown engine " << engineName << " or instrumentation " << instrumentName << endl;
+			return -1;
+		}
+		if (instrumentName == "binary" && traceFile.empty()) {
+			cout << "--instrument=binary needs --trace=FILE" << endl;
+			return -1;
+		}
+		DecodedProgram decoded;
+		decoded.decode(program);
+		ostringstream report;
+		ofstream trace;
+		if (!traceFile.empty()) {
+			trace.open(traceFile.c_str(), ios::binary);
+			if (!trace) {
+				cout << "Cannot write " << traceFile << endl;
+				return -1;
+			}
+		}
+		LiveStats live;
+		if (!liveStatsFile.empty() && !live.open(liveStatsFile)) {
+			cout << "Cannot write " << liveStatsFile << endl;
+			return -1;
+		}
+		EngineResult result = run(program, decoded, strtoull(maxInstructionsArg.c_str(), NULL, 10),
+			!traceFile.empty() ? (ostream &)trace : instrumentName == "trace" ? cout : report,
+			liveStatsFile.empty() ? NULL : &live);
+		cout << "(" << result.a0 << "," << result.a1 << ")" << endl;
+		cout << report.str();
+		return 0;
+	}
+
+	// per-PC profile; without a timing model the pre-decoded engine counts block entries
+	DecodedProgram *profiled = NULL;
+	PCProfile *pcProfile = NULL;
+	if (profileTop > 0) {
+		profiled = new DecodedProgram();
+		profiled->decode(program);
+		pcProfile = new PCProfile(*profiled);
+	}
+	if (pcProfile && !ooo && simpointProfile.empty() && checkpointIn.empty() && checkpointOut.empty() &&
+		liveStatsFile.empty()) {
+		FastEngine engine(*profiled);
+		engine.run_profiled(strtoull(maxInstructionsArg.c_str(), NULL, 10), pcProfile->entries());
+		cout << "(" << engine.get_register(10) << "," << engine.get_register(11) << ")" << endl;
+		pcProfile->report(cout, profileTop);
+		delete pcProfile;
+		delete profiled;
+		return 0;
+	}
 
 	CPU myCPU;  
-	
-	// Control signals
-	bool done = true;
-	bool regWrite = false;
-	bool aluSrc = false;
-	bool branch = false;
-	bool memRe = false;
-	bool memWr = false;
-	bool memToReg = false;
-	bool upperIm = false;
-	int aluOp = 0;
-
-	string curr_instruction = "";
-
-	// Decoded instruction
-	unsigned int opcode;
-	unsigned int rd;
-    unsigned int funct3;
-    unsigned int rs1;
-    unsigned int rs2;
-    unsigned int funct7;
+	OOOCore *core = ooo ? new OOOCore(oooConfig) : NULL;
+	BBVProfiler *profiler = simpointProfile.empty() ? NULL : new BBVProfiler(program.num_instructions(), interval);
+	SampledRun *sampled = NULL;
+	if (!simpointFile.empty()) {
+		ifstream pointsFile(simpointFile.c_str());
+		vector<SimPointChoice> points;
+		if (!read_simpoints(pointsFile, points)) {
+			cout << "error reading simpoints " << simpointFile << endl;
+			return -1;
+		}
+		sampled = new SampledRun(points, interval, *core);
+	}
+	ofstream intervalFile;
+	IntervalStats *intervalStats = NULL;
+	if (!intervalStatsFile.empty()) {
+		intervalFile.open(intervalStatsFile.c_str(), ios::binary);
+		if (!intervalFile) {
+			cout << "Cannot write " << intervalStatsFile << endl;
+			return -1;
+		}
+		intervalStats = new IntervalStats(intervalFile, interval, core);
+	}
+	bool needRetired = core || profiler || pcProfile || intervalStats;
+	RetiredInst retired;
+	LiveStats *live = NULL;
+	if (!liveStatsFile.empty()) {
+		live = new LiveStats();
+		if (!live->open(liveStatsFile)) {
+			cout << "Cannot write " << liveStatsFile << endl;
+			return -1;
+		}
+	}
 
+	// resume from a checkpoint instead of instruction 0
+	uint64_t instructions = 0;
+	if (!checkpointIn.empty() && !load_checkpoint(checkpointIn.c_str(), myCPU, &instructions, core)) {
+		cout << "error reading checkpoint " << checkpointIn << endl;
+		return -1;
+	}
+	fastForward += instructions;
+
+	bool done = true;
+	if (!checkpointOut.empty() && instructions >= fastForward) {
+		done = false;
+	}
 	while (done == true) // processor's main loop. Each iteration is equal to one clock cycle.  
 	{
-		//fetch
-		curr_instruction = myCPU.get_instruction(instMem);
+		bool detailed = instructions >= fastForward;
+		unsigned long fetchPC = myCPU.readPC();
+
+		// fetch, decode, execute and increment PC
+		done = myCPU.step(program.instructions(), needRetired ? &retired : NULL);
 
-		// cout << curr_instruction << endl;
+		// the timing models see instructions in retirement order;
+		// while fast-forwarding they are only warmed
+		if (needRetired && done) {
+			if (!detailed) {
+				if (core)
+					core->warm(retired);
+			}
+			else {
+				uint64_t cycles = core ? core->get_cycles() : 0;
+				if (sampled)
+					sampled->record(retired);
+				else if (core)
+					core->dispatch(retired);
+				if (pcProfile)
+					pcProfile->record(retired.pc, core ? core->get_cycles() - cycles : 0);
+				if (profiler)
+					profiler->record(retired);
+			}
+			if (intervalStats)
+				intervalStats->retire(retired);
+		}
+		if (done)
+			instructions++;
 
-		// decode
-		done = myCPU.decode_instruction(curr_instruction, &regWrite, &aluSrc, &branch, & memRe, &memWr, &memToReg, &upperIm, &aluOp,
-			&opcode, &rd, &funct3, &rs1, &rs2, &funct7);
+		// a redirected PC ends a basic block
+		if (live && myCPU.readPC() != fetchPC + 8)
+			live->publish(instructions, core);
+
+		if (!checkpointOut.empty() && instructions == fastForward)
+			break;
 
-		// execute
-		myCPU.execute(rd, rs1, rs2, aluOp, opcode, curr_instruction);
-		
-		// increment PC
-		myCPU.incPC();
 		if (myCPU.readPC() > maxPC * 8) {
 			break;
 		}
 	}
+
+	// the in-flight instructions retire before the last interval closes; a
+	// checkpoint keeps them in flight instead
+	if (core && !sampled && checkpointOut.empty())
+		core->drain();
+	if (live) {
+		live->finish(instructions, core);
+		delete live;
+	}
+	if (intervalStats) {
+		intervalStats->finish();
+		delete intervalStats;
+	}
+
+	if (!checkpointOut.empty()) {
+		if (!save_checkpoint(checkpointOut.c_str(), myCPU, instructions, core)) {
+			cout << "error writing checkpoint " << checkpointOut << endl;
+			return -1;
+		}
+		cout << "checkpoint " << checkpointOut << " at instruction " << instructions << endl;
+		delete core;
+		delete profiler;
+		delete sampled;
+		return 0;
+	}
 	int a0 = myCPU.get_register_value(10);	// a0
 	int a1 = myCPU.get_register_value(11);  //a1
 	
 	// print the results 
 	  cout << "(" << a0 << "," << a1 << ")" << endl;
 
+	if (sampled) {
+		sampled->finish();
+		sampled->print_stats(cout);
+		delete sampled;
+	}
+	else if (core) {
+		core->print_stats(cout);
+	}
+	delete core;
+
+	if (pcProfile) {
+		pcProfile->report(cout, profileTop);
+		delete pcProfile;
+		delete profiled;
+	}
+
+	if (profiler) {
+		profiler->finish();
+		vector<SimPointChoice> points = select_simpoints(profiler->intervals, maxK);
+		ofstream out(simpointProfile.c_str());
+		write_simpoints(out, points);
+		cout << "simpoint.intervals " << profiler->intervals.size() << endl;
+		cout << "simpoint.clusters " << points.size() << endl;
+		delete profiler;
+	}
+
 	return 0;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,199 @@
+// file: tools/genprog.cpp
+//
+// Generates large valid programs for scaling tests. The program is a
+// sequence of regions; each region is a loop nest of --loop-depth levels
+// running --iterations times per level around a body of random ALU, load,
+// store and forward-branch instructions. The dynamic instruction count is
+// roughly size * iterations^depth, reported on stderr.
+//
+//   g++ -O2 -I. tools/genprog.cpp -o genprog
+//   ./genprog --size=1000000 --branch-density=0.15 --footprint=2048 --loop-depth=2 > big.txt
+
+#include "Assembler.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// x26 holds 2048 so memory above the 12-bit immediate range is reachable;
+// x27-x31 are loop counters; the body writes x1-x25 only
+static const unsigned HIGH_BASE = 26;
+static const unsigned FIRST_COUNTER = 27;
+static const int MAX_DEPTH = 5;
+
+struct GeneratorConfig {
+    uint64_t size;          // static instructions
+    double branch_density;  // fraction of body instructions that are branches
+    double memory_density;  // fraction that are loads or stores
+    int footprint;          // bytes of data memory touched, up to 4096
+    int loop_depth;
+    int iterations;         // per loop level
+    int region;             // body instructions per loop nest
+    uint32_t seed;
+
+    GeneratorConfig()
+        : size(100000), branch_density(0.1), memory_density(0.3), footprint(4096), loop_depth(1),
+          iterations(4), region(256), seed(1) {}
+};
+
+class Generator {
+private:
+    const GeneratorConfig &config;
+    uint32_t state;
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    double chance() { return (next() & 0xFFFFFF) / 16777216.0; }
+    unsigned any_register() { return next() % 26; }        // x0-x25
+    unsigned body_register() { return 1 + next() % 25; }   // x1-x25
+
+    // a memory instruction within the footprint; words stay aligned
+    void memory(Assembler &a) {
+        bool word = next() & 1;
+        uint32_t address = next() % config.footprint;
+        if (word) {
+            address &= ~3u;
+        }
+        unsigned base = 0;
+        int32_t offset = address;
+        if (address >= 2048) {
+            base = HIGH_BASE;
+            offset -= 2048;
+        }
+        if (next() & 1) {
+            a.emit(word ? rv_lw(body_register(), base, offset) : rv_lb(body_register(), base, offset));
+        } else {
+            a.emit(word ? rv_sw(any_register(), base, offset) : rv_sb(any_register(), base, offset));
+        }
+    }
+
+    void alu(Assembler &a) {
+        unsigned rd = body_register(), rs1 = any_register(), rs2 = any_register();
+        int32_t imm = (int32_t)(next() & 0xFFF) - 2048;
+        switch (next() % 6) {
+            case 0: a.emit(rv_add(rd, rs1, rs2)); break;
+            case 1: a.emit(rv_xor(rd, rs1, rs2)); break;
+            case 2: a.emit(rv_addi(rd, rs1, imm)); break;
+            case 3: a.emit(rv_ori(rd, rs1, imm)); break;
+            case 4: a.emit(rv_srai(rd, rs1, next() & 31)); break;
+            default: a.emit(rv_lui(rd, next())); break;
+        }
+    }
+
+    // `count` instructions of straight-line code with forward branches
+    // that skip up to eight instructions but never leave the body
+    void body(Assembler &a, uint64_t count) {
+        size_t end = a.here() + count;
+        while (a.here() < end) {
+            size_t left = end - a.here();
+            double roll = chance();
+            if (roll < config.branch_density && left > 1) {
+                size_t skip = 1 + next() % (left - 1 < 8 ? left - 1 : 8);
+                a.emit(rv_beq(any_register(), any_register(), (int32_t)(skip + 1) * 4));
+            } else if (roll < config.branch_density + config.memory_density) {
+                memory(a);
+            } else {
+                alu(a);
+            }
+        }
+    }
+
+    void nest(Assembler &a, int level, uint64_t count) {
+        if (level == config.loop_depth) {
+            body(a, count);
+            return;
+        }
+        unsigned counter = FIRST_COUNTER + level;
+        a.li(counter, config.iterations);
+        size_t head = a.here();
+        nest(a, level + 1, count);
+        a.emit(rv_addi(counter, counter, -1));
+        a.emit(rv_beq(counter, 0, 8));
+        a.jal(0, head);
+    }
+
+public:
+    explicit Generator(const GeneratorConfig &cfg) : config(cfg), state(cfg.seed ? cfg.seed : 1) {}
+
+    void generate(Assembler &a) {
+        a.li(HIGH_BASE, 2048);
+        uint64_t overhead = 4 * config.loop_depth;
+        while (a.here() < config.size) {
+            uint64_t left = config.size - a.here();
+            uint64_t count = left > overhead + config.region ? config.region : (left > overhead ? left - overhead : 1);
+            nest(a, 0, count);
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    GeneratorConfig config;
+    std::string format = "text", output;
+    for (int a = 1; a < argc; a++) {
+        const char *arg = argv[a];
+        if (strncmp(arg, "--size=", 7) == 0) config.size = strtoull(arg + 7, NULL, 10);
+        else if (strncmp(arg, "--branch-density=", 17) == 0) config.branch_density = atof(arg + 17);
+        else if (strncmp(arg, "--memory-density=", 17) == 0) config.memory_density = atof(arg + 17);
+        else if (strncmp(arg, "--footprint=", 12) == 0) config.footprint = atoi(arg + 12);
+        else if (strncmp(arg, "--loop-depth=", 13) == 0) config.loop_depth = atoi(arg + 13);
+        else if (strncmp(arg, "--iterations=", 13) == 0) config.iterations = atoi(arg + 13);
+        else if (strncmp(arg, "--region=", 9) == 0) config.region = atoi(arg + 9);
+        else if (strncmp(arg, "--seed=", 7) == 0) config.seed = strtoul(arg + 7, NULL, 10);
+        else if (strncmp(arg, "--format=", 9) == 0) format = arg + 9;
+        else if (strncmp(arg, "--output=", 9) == 0) output = arg + 9;
+        else {
+            fprintf(stderr, "unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    if (config.loop_depth < 0 || config.loop_depth > MAX_DEPTH) {
+        fprintf(stderr, "--loop-depth must be 0 to %d\n", MAX_DEPTH);
+        return 1;
+    }
+    if (config.footprint < 4 || config.footprint > 4096) {
+        fprintf(stderr, "--footprint must be 4 to 4096 bytes\n");
+        return 1;
+    }
+    if (config.iterations < 1 || config.region < 1 || config.region > 65536) {
+        fprintf(stderr, "--iterations must be positive and --region 1 to 65536\n");
+        return 1;
+    }
+    if (format != "text" && format != "binary" && format != "hex") {
+        fprintf(stderr, "--format must be text, binary or hex\n");
+        return 1;
+    }
+
+    Assembler program;
+    program.words.reserve(config.size + 16);
+    Generator(config).generate(program);
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output.c_str(), std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "cannot write %s\n", output.c_str());
+            return 1;
+        }
+    }
+    std::ostream &out = output.empty() ? std::cout : file;
+    if (format == "binary") {
+        program.write_binary(out);
+    } else if (format == "hex") {
+        program.write_hex(out);
+    } else {
+        program.write(out);
+    }
+    out.flush();
+    fprintf(stderr, "genprog.instructions %zu\n", program.words.size());
+    fprintf(stderr, "genprog.dynamic_estimate %.0f\n",
+            (double)program.words.size() * pow((double)config.iterations, config.loop_depth));
+    return 0;
+}
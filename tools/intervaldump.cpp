@@ -0,0 +1,72 @@
+// file: tools/intervaldump.cpp
+//
+// Prints an interval statistics file written with --interval-stats=FILE as
+// CSV: one row per interval with the instruction mix, CPI, D-cache miss
+// rate and branch MPKI, or the raw counter columns with --raw.
+//
+//   g++ -O2 -I. tools/intervaldump.cpp IntervalStats.cpp -o intervaldump
+
+#include "IntervalStats.h"
+
+#include <cstdio>
+#include <cstring>
+
+static double ratio(uint64_t part, uint64_t whole) {
+    return whole ? (double)part / whole : 0.0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    bool raw = false;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--raw") == 0) {
+            raw = true;
+        } else {
+            path = argv[a];
+        }
+    }
+    std::vector<std::string> names;
+    std::vector<std::vector<uint64_t> > columns;
+    if (!path || !read_interval_stats(path, names, columns)) {
+        fprintf(stderr, "usage: intervaldump [--raw] FILE (an --interval-stats file)\n");
+        return 1;
+    }
+    size_t rows = columns.empty() ? 0 : columns[0].size();
+
+    if (raw) {
+        printf("interval");
+        for (size_t c = 0; c < names.size(); c++) {
+            printf(",%s", names[c].c_str());
+        }
+        printf("\n");
+        for (size_t r = 0; r < rows; r++) {
+            printf("%zu", r);
+            for (size_t c = 0; c < columns.size(); c++) {
+                printf(",%llu", (unsigned long long)columns[c][r]);
+            }
+            printf("\n");
+        }
+        return 0;
+    }
+
+    // the derived view needs the columns this version writes
+    if (columns.size() < STAT_COUNTERS) {
+        fprintf(stderr, "%s has %zu columns, expected %d; use --raw\n", path, columns.size(), STAT_COUNTERS);
+        return 1;
+    }
+    printf("interval,start,instructions,alu,loads,stores,branches,taken,cpi,dcache_miss_rate,bpred_mpki\n");
+    uint64_t start = 0;
+    for (size_t r = 0; r < rows; r++) {
+        uint64_t instructions = columns[STAT_INSTRUCTIONS][r];
+        uint64_t accesses = columns[STAT_DCACHE_HITS][r] + columns[STAT_DCACHE_MISSES][r];
+        printf("%zu,%llu,%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f\n", r, (unsigned long long)start,
+               (unsigned long long)instructions, ratio(columns[STAT_ALU][r], instructions),
+               ratio(columns[STAT_LOADS][r], instructions), ratio(columns[STAT_STORES][r], instructions),
+               ratio(columns[STAT_BRANCHES][r] + columns[STAT_JUMPS][r], instructions),
+               ratio(columns[STAT_TAKEN_BRANCHES][r], columns[STAT_BRANCHES][r]),
+               ratio(columns[STAT_CYCLES][r], instructions), ratio(columns[STAT_DCACHE_MISSES][r], accesses),
+               1000.0 * ratio(columns[STAT_BPRED_MISPREDICTS][r], instructions));
+        start += instructions;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// file: tools/monitor.cpp
+//
+// Follows a running simulation started with --live-stats=FILE by reading
+// the shared statistics page; the simulator is never signalled or
+// blocked.
+//
+//   g++ -O2 -I. tools/monitor.cpp LiveStats.cpp -o monitor
+//   ./monitor [--interval=MS] [--once] FILE
+
+#include "LiveStats.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double ratio(uint64_t part, uint64_t whole) {
+    return whole ? (double)part / whole : 0.0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    int interval_ms = 1000;
+    bool once = false;
+    for (int a = 1; a < argc; a++) {
+        if (strncmp(argv[a], "--interval=", 11) == 0) {
+            interval_ms = atoi(argv[a] + 11);
+        } else if (strcmp(argv[a], "--once") == 0) {
+            once = true;
+        } else {
+            path = argv[a];
+        }
+    }
+    if (!path || interval_ms < 1) {
+        fprintf(stderr, "usage: monitor [--interval=MS] [--once] FILE\n");
+        return 1;
+    }
+
+    // the simulator may not have created the file yet
+    const LiveStatsPage *page = NULL;
+    for (int attempt = 0; attempt < 50 && !(page = map_live_stats(path)); attempt++) {
+        usleep(100000);
+    }
+    if (!page) {
+        fprintf(stderr, "%s is not a live statistics file\n", path);
+        return 1;
+    }
+
+    uint64_t last_instructions = page->instructions.load(std::memory_order_relaxed);
+    uint64_t last_time = now_ns();
+    while (true) {
+        if (!once) {
+            usleep(interval_ms * 1000);
+        }
+        uint32_t state = page->state.load(std::memory_order_acquire);
+        uint64_t instructions = page->instructions.load(std::memory_order_relaxed);
+        uint64_t cycles = page->cycles.load(std::memory_order_relaxed);
+        uint64_t hits = page->dcache_hits.load(std::memory_order_relaxed);
+        uint64_t misses = page->dcache_misses.load(std::memory_order_relaxed);
+        uint64_t lookups = page->bpred_lookups.load(std::memory_order_relaxed);
+        uint64_t mispredicts = page->bpred_mispredicts.load(std::memory_order_relaxed);
+        uint64_t time = now_ns();
+
+        // current rate over the last interval, or the average for --once
+        double mips = once ? ratio(instructions, time - page->start_ns) * 1000.0
+                           : ratio(instructions - last_instructions, time - last_time) * 1000.0;
+        printf("%.1fs instructions %llu mips %.2f", (time - page->start_ns) / 1e9, (unsigned long long)instructions,
+               mips);
+        if (cycles) {
+            printf(" ipc %.3f dcache_miss %.2f%% bpred_mispredict %.2f%%", ratio(instructions, cycles),
+                   100.0 * ratio(misses, hits + misses), 100.0 * ratio(mispredicts, lookups));
+        }
+        printf("%s\n", state == LIVE_FINISHED ? " finished" : "");
+        fflush(stdout);
+        last_instructions = instructions;
+        last_time = time;
+
+        if (once || state == LIVE_FINISHED) {
+            break;
+        }
+        if (kill(page->pid, 0) != 0 && errno == ESRCH) {
+            printf("simulator exited\n");
+            break;
+        }
+    }
+    unmap_live_stats(page);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// file: tools/tracedump.cpp
+//
+// Prints a binary trace written with cpusim --trace=FILE as text, in the
+// same line format as --instrument=trace, or a summary with --stats.
+//
+//   g++ -O2 -pthread -I. tools/tracedump.cpp Trace.cpp -o tracedump
+
+#include "Trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    bool stats = false;
+    uint64_t limit = 0;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--stats") == 0) {
+            stats = true;
+        } else if (strncmp(argv[a], "--limit=", 8) == 0) {
+            limit = strtoull(argv[a] + 8, NULL, 10);
+        } else {
+            path = argv[a];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: tracedump [--stats] [--limit=N] trace\n");
+        return 1;
+    }
+    MappedTrace trace(path);
+    if (!trace.is_open()) {
+        fprintf(stderr, "%s is not a trace file\n", path);
+        return 1;
+    }
+    TraceReader reader(trace);
+
+    uint64_t records = 0, loads = 0, stores = 0, writes = 0;
+    TraceRecord record;
+    while ((!limit || records < limit) && reader.next(record)) {
+        records++;
+        writes += (record.flags & TRACE_REG) != 0;
+        loads += (record.flags & TRACE_LOAD) != 0;
+        stores += (record.flags & TRACE_STORE) != 0;
+        if (stats) {
+            continue;
+        }
+        printf("pc 0x%04x inst 0x%08x", record.pc, record.word);
+        if (record.flags & TRACE_REG) {
+            printf(" x%u=%d", record.rd, record.value);
+        }
+        if (record.flags & (TRACE_LOAD | TRACE_STORE)) {
+            const char *kind = (record.flags & TRACE_LOAD) && (record.flags & TRACE_STORE) ? "amo"
+                               : (record.flags & TRACE_LOAD) ? "load" : "store";
+            printf(" %s 0x%x = %d", kind, record.mem_address, record.mem_value);
+        }
+        if (record.flags & TRACE_TAKEN) {
+            printf(" taken");
+        }
+        printf("\n");
+    }
+    if (stats) {
+        printf("trace.records %llu\n", (unsigned long long)records);
+        printf("trace.register_writes %llu\n", (unsigned long long)writes);
+        printf("trace.loads %llu\n", (unsigned long long)loads);
+        printf("trace.stores %llu\n", (unsigned long long)stores);
+    }
+    return 0;
+}